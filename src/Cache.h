@@ -45,6 +45,8 @@
 #pragma once
 
 #include <cstddef>
+#include <string>
+#include <type_traits>
 #include <unordered_map>
 #include "utils/printutils.h"
 
@@ -122,6 +124,15 @@ public:
 
   bool remove(const Key& key);
   T *take(const Key& key);
+  // Returns the stored copy of key, which stays valid until the entry is removed
+  const Key *key(const Key& key) const {
+    auto i = hash.find(key);
+    return i == hash.end() ? nullptr : &i->first;
+  }
+  // Changes the cost of an existing entry. Trims the cache, which may remove the entry itself.
+  bool setCost(const Key& key, size_t cost);
+  // Removes all entries for which pred(object) returns true. Returns the number of removed entries.
+  template <class Pred> size_t removeIf(Pred pred);
 
 private:
   void trim(size_t m);
@@ -139,6 +150,34 @@ inline bool Cache<Key, T>::remove(const Key& key)
   }
 }
 
+template <class Key, class T>
+inline bool Cache<Key, T>::setCost(const Key& key, size_t cost)
+{
+  auto i = hash.find(key);
+  if (i == hash.end()) return false;
+  total = total - i->second.c + cost;
+  i->second.c = cost;
+  trim(mx);
+  return true;
+}
+
+template <class Key, class T>
+template <class Pred>
+size_t Cache<Key, T>::removeIf(Pred pred)
+{
+  size_t removed = 0;
+  Node *n = f;
+  while (n) {
+    Node *u = n;
+    n = n->n;
+    if (pred(static_cast<const T&>(*u->t))) {
+      unlink(*u);
+      ++removed;
+    }
+  }
+  return removed;
+}
+
 template <class Key, class T>
 inline T *Cache<Key, T>::take(const Key& key)
 {
@@ -182,7 +221,9 @@ void Cache<Key, T>::trim(size_t m)
     Node *u = n;
     n = n->p;
 #ifdef DEBUG
-    LOG("Trimming cache: %1$s (%2$d bytes)", u->keyPtr->substr(0, 40), u->c);
+    if constexpr (std::is_same_v<Key, std::string>) {
+      LOG("Trimming cache: %1$s (%2$d bytes)", u->keyPtr->substr(0, 40), u->c);
+    }
 #endif
     unlink(*u);
   }
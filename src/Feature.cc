@@ -29,9 +29,17 @@ const Feature Feature::ExperimentalRoof("roof", "Enable <code>roof</code>");
 const Feature Feature::ExperimentalInputDriverDBus("input-driver-dbus", "Enable DBus input drivers (requires restart)");
 const Feature Feature::ExperimentalLazyUnion("lazy-union", "Enable lazy unions.");
 const Feature Feature::ExperimentalVxORenderersIndexing("vertex-object-renderers-indexing", "Enable indexing in vertex object renderers");
+const Feature Feature::ExperimentalVxORenderersInstancing("vertex-object-renderers-instancing", "Upload geometry shared by several preview objects once and draw each object with its own transform");
+const Feature Feature::ExperimentalPreviewLOD("preview-lod", "Draw simplified meshes for objects covering few pixels in the interactive view. Renders and exports always use full resolution.");
 const Feature Feature::ExperimentalTextMetricsFunctions("textmetrics", "Enable the <code>textmetrics()</code> and <code>fontmetrics()</code> functions.");
 const Feature Feature::ExperimentalImportFunction("import-function", "Enable import function returning data instead of geometry.");
 const Feature Feature::ExperimentalPredictibleOutput("predictible-output", "Attempt to produce predictible, diffable outputs (e.g. sorting the STL, or remeshing in a determined order)");
+const Feature Feature::ExperimentalCsgOptimizer("csg-optimizer", "Simplify the CSG tree (flatten unions, fold transformations, drop empty objects) before rendering.");
+const Feature Feature::ExperimentalBoundingBoxShortcuts("bounding-box-shortcuts", "Skip 3D boolean operations decided by bounding boxes: Unions of disjoint objects are concatenated rather than merged with CGAL, and differences without overlapping subtrahends return the first object as is.");
+const Feature Feature::ExperimentalManifoldFloatMesh("manifold-float-mesh", "Use single precision meshes when converting float-exact data (e.g. STL imports) to and from Manifold.");
+const Feature Feature::ExperimentalModuleMemoization("module-memoization", "Share the objects of repeated module calls with identical arguments and special variables, unless the module has side effects (e.g. <code>echo()</code> or <code>rands()</code>) or children.");
+const Feature Feature::ExperimentalFunctionMemoization("function-memoization", "Reuse the results of user function calls with identical arguments and special variables, unless evaluating them had side effects (e.g. <code>echo()</code> or <code>rands()</code>).");
+const Feature Feature::ExperimentalParallelListComprehension("parallel-list-comprehension", "Evaluate the iterations of large <code>for</code> list comprehensions on several threads. Falls back to sequential evaluation if an iteration logs messages or uses functions like <code>rands()</code>.");
 #ifdef ENABLE_PYTHON
 const Feature Feature::ExperimentalPythonEngine("python-engine", "Enable experimental Python Engine (implies risk of malicious scripts downloaded).");
 #endif
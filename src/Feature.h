@@ -17,9 +17,17 @@ public:
   static const Feature ExperimentalInputDriverDBus;
   static const Feature ExperimentalLazyUnion;
   static const Feature ExperimentalVxORenderersIndexing;
+  static const Feature ExperimentalVxORenderersInstancing;
+  static const Feature ExperimentalPreviewLOD;
   static const Feature ExperimentalTextMetricsFunctions;
   static const Feature ExperimentalImportFunction;
   static const Feature ExperimentalPredictibleOutput;
+  static const Feature ExperimentalCsgOptimizer;
+  static const Feature ExperimentalBoundingBoxShortcuts;
+  static const Feature ExperimentalManifoldFloatMesh;
+  static const Feature ExperimentalModuleMemoization;
+  static const Feature ExperimentalFunctionMemoization;
+  static const Feature ExperimentalParallelListComprehension;
 #ifdef ENABLE_PYTHON
   static const Feature ExperimentalPythonEngine;
 #endif
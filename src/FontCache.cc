@@ -27,7 +27,9 @@
 #include "FontCache.h"
 
 #include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 #include <filesystem>
@@ -35,6 +37,7 @@
 #include <string>
 #include <utility>
 
+#include "FontIndex.h"
 #include "platform/PlatformUtils.h"
 #include "utils/printutils.h"
 #include "utils/version_helper.h"
@@ -148,7 +151,7 @@ FontCache::FontCache()
     builtinfontpath = fs::canonical(builtinfontpath);
 #endif
     FcConfigParseAndLoad(this->config, reinterpret_cast<const FcChar8 *>(builtinfontpath.generic_string().c_str()), false);
-    add_font_dir(builtinfontpath.generic_string());
+    this->font_dirs.push_back(builtinfontpath.generic_string());
   }
 
   const char *home = getenv("HOME");
@@ -156,7 +159,7 @@ FontCache::FontCache()
   // Add Linux font folders, the system folders are expected to be
   // configured by the system configuration for fontconfig.
   if (home) {
-    add_font_dir(std::string(home) + "/.fonts");
+    this->font_dirs.push_back(std::string(home) + "/.fonts");
   }
 
   const char *env_font_path = getenv("OPENSCAD_FONT_PATH");
@@ -168,20 +171,40 @@ FontCache::FontCache()
       const fs::path p(boost::copy_range<std::string>(*it));
       if (fs::exists(p) && fs::is_directory(p)) {
         std::string path = fs::absolute(p).string();
-        add_font_dir(path);
+        this->font_dirs.push_back(path);
       }
     }
   }
 
-  FontCacheInitializer initializer(this->config);
-  cb_handler(&initializer, cb_userdata);
-
-  // For use by LibraryInfo
-  FcStrList *dirs = FcConfigGetFontDirs(this->config);
+  // The font directories named by the configuration, without building the font set.
+  // These are replaced by all scanned directories once fontconfig builds its fonts.
+  std::vector<std::string> roots = this->font_dirs;
+  FcStrList *dirs = FcConfigGetConfigDirs(this->config);
   while (FcChar8 *dir = FcStrListNext(dirs)) {
-    fontpath.emplace_back((const char *)dir);
+    roots.emplace_back((const char *)dir);
   }
   FcStrListDone(dirs);
+  for (const auto& dir : roots) {
+    if (fs::is_directory(dir)) fontpath.push_back(dir);
+  }
+
+  const std::string cachepath = PlatformUtils::userCachePath();
+  if (!cachepath.empty()) {
+    std::vector<std::string> configFiles;
+    FcStrList *files = FcConfigGetConfigFiles(this->config);
+    while (FcChar8 *file = FcStrListNext(files)) {
+      configFiles.emplace_back((const char *)file);
+    }
+    FcStrListDone(files);
+
+    // Font matching depends on the language settings
+    std::string environment = "fontconfig=" + std::to_string(FcGetVersion());
+    for (const char *var : {"FC_LANG", "LC_ALL", "LC_CTYPE", "LANG"}) {
+      const char *value = getenv(var);
+      environment += std::string(" ") + var + "=" + (value ? value : "");
+    }
+    this->index = std::make_unique<FontIndex>(cachepath + "/fontindex.txt", std::move(roots), std::move(configFiles), std::move(environment));
+  }
 
   const FT_Error error = FT_Init_FreeType(&this->library);
   if (error) {
@@ -192,10 +215,52 @@ FontCache::FontCache()
   this->init_ok = true;
 }
 
+FontCache::~FontCache() = default;
+
+/**
+ * Scans the font directories, which can take a while for large font collections.
+ * This is only done once a font lookup misses the font index, or all fonts are needed.
+ * Lookups can happen during evaluation, possibly on a worker thread, so only callers
+ * on the GUI thread (listing fonts) may show progress through the registered handler.
+ */
+void FontCache::build_fonts(bool show_progress)
+{
+  if (this->fonts_built) {
+    return;
+  }
+  this->fonts_built = true;
+
+  for (const auto& dir : this->font_dirs) {
+    add_font_dir(dir);
+  }
+
+  FontCacheInitializer initializer(this->config);
+  if (show_progress) {
+    cb_handler(&initializer, cb_userdata);
+  } else {
+    initializer.run();
+  }
+  if (this->index) {
+    this->index->scan();
+  }
+
+  // For use by LibraryInfo
+  fontpath.clear();
+  FcStrList *dirs = FcConfigGetFontDirs(this->config);
+  while (FcChar8 *dir = FcStrListNext(dirs)) {
+    fontpath.emplace_back((const char *)dir);
+  }
+  FcStrListDone(dirs);
+}
+
 FontCache *FontCache::instance()
 {
   if (!self) {
     self = new FontCache();
+    // Write the font index once, rather than on every lookup adding to it
+    std::atexit([] {
+      if (self->index) self->index->flush();
+    });
   }
   return self;
 }
@@ -222,6 +287,9 @@ void FontCache::registerProgressHandler(InitHandlerFunc *handler, void *userdata
 
 void FontCache::register_font_file(const std::string& path)
 {
+  // The index only knows about fonts found through the configuration
+  build_fonts();
+  this->app_fonts_registered = true;
   if (!FcConfigAppFontAddFile(this->config, reinterpret_cast<const FcChar8 *>(path.c_str()))) {
     LOG("Can't register font '%1$s'", path);
   }
@@ -237,8 +305,9 @@ void FontCache::add_font_dir(const std::string& path)
   }
 }
 
-std::vector<uint32_t> FontCache::filter(const std::u32string& str) const
+std::vector<uint32_t> FontCache::filter(const std::u32string& str)
 {
+  build_fonts(true);
   FcObjectSet *object_set = FcObjectSetBuild(FC_FAMILY, FC_STYLE, FC_FILE, nullptr);
   FcPattern *pattern = FcPatternCreate();
   init_pattern(pattern);
@@ -265,8 +334,9 @@ std::vector<uint32_t> FontCache::filter(const std::u32string& str) const
   return result;
 }
 
-FontInfoList *FontCache::list_fonts() const
+FontInfoList *FontCache::list_fonts()
 {
+  build_fonts(true);
   FcObjectSet *object_set = FcObjectSetBuild(FC_FAMILY, FC_STYLE, FC_FILE, nullptr);
   FcPattern *pattern = FcPatternCreate();
   init_pattern(pattern);
@@ -306,6 +376,7 @@ bool FontCache::is_init_ok() const
 void FontCache::clear()
 {
   this->cache.clear();
+  this->face_ids.clear();
 }
 
 void FontCache::dump_cache(const std::string& info)
@@ -329,6 +400,7 @@ void FontCache::check_cleanup()
       pos = it;
     }
   }
+  this->face_ids.erase((*pos).second.first);
   FT_Done_Face((*pos).second.first);
   this->cache.erase(pos);
 }
@@ -338,11 +410,13 @@ FT_Face FontCache::get_font(const std::string& font)
   FT_Face face;
   auto it = this->cache.find(font);
   if (it == this->cache.end()) {
-    face = find_face(font);
+    std::string id;
+    face = find_face(font, id);
     if (!face) {
       return nullptr;
     }
     check_cleanup();
+    this->face_ids[face] = id;
   } else {
     face = (*it).second.first;
   }
@@ -350,14 +424,28 @@ FT_Face FontCache::get_font(const std::string& font)
   return face;
 }
 
-FT_Face FontCache::find_face(const std::string& font) const
+std::string FontCache::get_face_id(FT_Face face) const
+{
+  auto it = this->face_ids.find(face);
+  return it == this->face_ids.end() ? std::string() : it->second;
+}
+
+FT_Face FontCache::find_face(const std::string& font, std::string& id)
 {
   std::string trimmed(font);
   boost::algorithm::trim(trimmed);
 
   const std::string lookup = trimmed.empty() ? DEFAULT_FONT : trimmed;
   PRINTDB("font = \"%s\", lookup = \"%s\"", font % lookup);
-  FT_Face face = find_face_fontconfig(lookup);
+  FT_Face face = nullptr;
+  std::string file;
+  int face_index;
+  if (this->index && !this->app_fonts_registered && this->index->lookup(lookup, file, face_index)) {
+    face = open_face(file, face_index, id);
+  }
+  if (!face) {
+    face = find_face_fontconfig(lookup, id);
+  }
   if (face) {
     PRINTDB("result = \"%s\", style = \"%s\"", face->family_name % face->style_name);
   } else {
@@ -378,8 +466,10 @@ void FontCache::init_pattern(FcPattern *pattern) const
   FcPatternAdd(pattern, FC_SCALABLE, true_value, true);
 }
 
-FT_Face FontCache::find_face_fontconfig(const std::string& font) const
+FT_Face FontCache::find_face_fontconfig(const std::string& font, std::string& id)
 {
+  build_fonts();
+
   FcResult result;
 
   FcPattern *pattern = FcNameParse((unsigned char *)font.c_str());
@@ -404,12 +494,28 @@ FT_Face FontCache::find_face_fontconfig(const std::string& font) const
     return nullptr;
   }
 
-  FT_Face face;
-  FT_Error error = FT_New_Face(this->library, (const char *) file_value.u.s, font_index.u.i, &face);
+  const std::string file((const char *) file_value.u.s);
+  const int face_index = font_index.u.i;
 
   FcPatternDestroy(pattern);
   FcPatternDestroy(match);
 
+  FT_Face face = open_face(file, face_index, id);
+  if (face && this->index && !this->app_fonts_registered) {
+    this->index->insert(font, file, face_index);
+  }
+  return face;
+}
+
+FT_Face FontCache::open_face(const std::string& file, int index, std::string& id) const
+{
+  FT_Face face;
+  FT_Error error = FT_New_Face(this->library, file.c_str(), index, &face);
+  if (error) {
+    return nullptr;
+  }
+  id = file + ":" + std::to_string(index);
+
   for (int a = 0; a < face->num_charmaps; ++a) {
     FT_CharMap charmap = face->charmaps[a];
     PRINTDB("charmap = %d: platform = %d, encoding = %d", a % charmap->platform_id % charmap->encoding_id);
@@ -429,7 +535,7 @@ FT_Face FontCache::find_face_fontconfig(const std::string& font) const
     if (!charmap_set) LOG(message_group::Font_Warning, "Could not select a char map for font '%1$s/%2$s'", face->family_name, face->style_name);
   }
 
-  return error ? nullptr : face;
+  return face;
 }
 
 bool FontCache::try_charmap(FT_Face face, int platform_id, int encoding_id) const
@@ -28,6 +28,7 @@
 #include <utility>
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 
 #include <ctime>
@@ -63,6 +64,8 @@ private:
 
 using FontInfoList = std::vector<FontInfo>;
 
+class FontIndex;
+
 /**
  * Slow call of the font cache initialization. This is separated here so it
  * can be passed to the GUI to run in a separate thread while showing a
@@ -84,15 +87,17 @@ public:
   const static unsigned int MAX_NR_OF_CACHE_ENTRIES = 3;
 
   FontCache();
-  virtual ~FontCache() = default;
+  virtual ~FontCache();
 
   [[nodiscard]] bool is_init_ok() const;
   FT_Face get_font(const std::string& font);
+  // Identifies the font file and face index of a face returned by get_font(), e.g. for caching glyphs
+  [[nodiscard]] std::string get_face_id(FT_Face face) const;
   [[nodiscard]] bool is_windows_symbol_font(const FT_Face& face) const;
   void register_font_file(const std::string& path);
   void clear();
-  [[nodiscard]] FontInfoList *list_fonts() const;
-  [[nodiscard]] std::vector<uint32_t> filter(const std::u32string&) const;
+  [[nodiscard]] FontInfoList *list_fonts();
+  [[nodiscard]] std::vector<uint32_t> filter(const std::u32string&);
   [[nodiscard]] const std::string get_freetype_version() const;
 
   static FontCache *instance();
@@ -112,17 +117,27 @@ private:
 
   bool init_ok;
   cache_t cache;
+  std::map<FT_Face, std::string> face_ids;
   FcConfig *config;
   FT_Library library;
 
+  // Fontconfig only scans the font directories once a font can't be found in the index
+  std::vector<std::string> font_dirs;
+  bool fonts_built{false};
+  bool app_fonts_registered{false};
+  std::unique_ptr<FontIndex> index;
+
+  void build_fonts(bool show_progress = false);
+
   void check_cleanup();
   void dump_cache(const std::string& info);
 
   void add_font_dir(const std::string& path);
   void init_pattern(FcPattern *pattern) const;
 
-  [[nodiscard]] FT_Face find_face(const std::string& font) const;
-  [[nodiscard]] FT_Face find_face_fontconfig(const std::string& font) const;
+  [[nodiscard]] FT_Face find_face(const std::string& font, std::string& id);
+  [[nodiscard]] FT_Face find_face_fontconfig(const std::string& font, std::string& id);
+  [[nodiscard]] FT_Face open_face(const std::string& file, int index, std::string& id) const;
   bool try_charmap(FT_Face face, int platform_id, int encoding_id) const;
 };
 
@@ -0,0 +1,173 @@
+#include "FontIndex.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "utils/printutils.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::string HEADER = "OpenSCAD font index 1";
+
+// Modification time of a file or directory, -1 if it doesn't exist
+int64_t get_mtime(const std::string& path)
+{
+  std::error_code ec;
+  const auto time = fs::last_write_time(fs::path{path}, ec);
+  return ec ? -1 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+// Index entries are line and tab separated
+bool is_storable(const std::string& str)
+{
+  return str.find_first_of("\t\n\r") == std::string::npos;
+}
+
+} // namespace
+
+FontIndex::FontIndex(std::string path, std::vector<std::string> roots, std::vector<std::string> configFiles, std::string environment)
+  : path(std::move(path)), roots(std::move(roots)), configFiles(std::move(configFiles)), environment(std::move(environment))
+{
+  if (!load()) {
+    this->fonts.clear();
+  }
+}
+
+bool FontIndex::lookup(const std::string& font, std::string& file, int& index) const
+{
+  auto it = this->fonts.find(font);
+  if (it == this->fonts.end()) return false;
+  file = it->second.first;
+  index = it->second.second;
+  return true;
+}
+
+void FontIndex::insert(const std::string& font, const std::string& file, int index)
+{
+  if (!is_storable(font) || !is_storable(file)) return;
+  this->fonts[font] = {file, index};
+  this->dirty = true;
+}
+
+void FontIndex::flush()
+{
+  if (!this->dirty) return;
+  if (!this->scanned) scan();
+  save();
+  this->dirty = false;
+}
+
+/*!
+   Reads the index file. Returns false if it's missing, from another version, or
+   doesn't match the current font configuration.
+ */
+bool FontIndex::load()
+{
+  std::ifstream in(this->path);
+  if (!in) return false;
+
+  std::string line;
+  if (!std::getline(in, line) || line != HEADER) return false;
+  if (!std::getline(in, line) || line != "env " + this->environment) return false;
+
+  size_t root = 0, conf = 0;
+  while (std::getline(in, line)) {
+    const auto sep = line.find(' ');
+    if (sep == std::string::npos) return false;
+    const auto kind = line.substr(0, sep);
+    std::istringstream fields(line.substr(sep + 1));
+    if (kind == "root") {
+      if (root >= this->roots.size() || line.substr(sep + 1) != this->roots[root++]) return false;
+    } else if (kind == "dir" || kind == "conf") {
+      int64_t mtime;
+      std::string stamped;
+      if (!(fields >> mtime) || fields.get() != ' ' || !std::getline(fields, stamped)) return false;
+      if (kind == "conf" && (conf >= this->configFiles.size() || stamped != this->configFiles[conf++])) return false;
+      // Adding or removing files and subdirectories changes the directory's modification time
+      if (get_mtime(stamped) != mtime) return false;
+      (kind == "dir" ? this->dirs : this->confs).emplace_back(std::move(stamped), mtime);
+    } else if (kind == "font") {
+      std::string file, index, font;
+      if (!std::getline(fields, file, '\t') || !std::getline(fields, index, '\t') || !std::getline(fields, font)) return false;
+      try {
+        this->fonts[font] = {file, std::stoi(index)};
+      } catch (const std::exception&) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+  if (root != this->roots.size() || conf != this->configFiles.size()) return false;
+
+  this->scanned = true;
+  PRINTDB("Loaded %d fonts from font index %s", this->fonts.size() % this->path);
+  return true;
+}
+
+/*!
+   Records the modification times of the font directories and configuration files
+   the index depends on. Should be called when fontconfig scans the font directories,
+   so the index is invalidated by any later change.
+ */
+void FontIndex::scan()
+{
+  this->dirs.clear();
+  this->confs.clear();
+  for (const auto& root : this->roots) {
+    this->dirs.emplace_back(root, get_mtime(root));
+    std::error_code ec;
+    fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec);
+    for (const fs::recursive_directory_iterator end; !ec && it != end; it.increment(ec)) {
+      if (it->is_directory(ec)) {
+        const auto dir = it->path().generic_string();
+        if (is_storable(dir)) this->dirs.emplace_back(dir, get_mtime(dir));
+      }
+    }
+  }
+  for (const auto& file : this->configFiles) {
+    this->confs.emplace_back(file, get_mtime(file));
+  }
+  this->scanned = true;
+}
+
+void FontIndex::save() const
+{
+  std::error_code ec;
+  const fs::path file{this->path};
+  fs::create_directories(file.parent_path(), ec);
+
+  // Write to a temporary file first, so concurrent processes never read a partial index
+  const fs::path tmp{this->path + "." + std::to_string(std::random_device{}()) + ".tmp"};
+  {
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out) {
+      PRINTDB("Can't write font index %s", this->path);
+      return;
+    }
+    out << HEADER << "\n";
+    out << "env " << this->environment << "\n";
+    for (const auto& root : this->roots) out << "root " << root << "\n";
+    for (const auto& [dir, mtime] : this->dirs) out << "dir " << mtime << " " << dir << "\n";
+    for (const auto& [conf, mtime] : this->confs) out << "conf " << mtime << " " << conf << "\n";
+    for (const auto& [font, match] : this->fonts) {
+      out << "font " << match.first << "\t" << match.second << "\t" << font << "\n";
+    }
+    if (!out) {
+      out.close();
+      fs::remove(tmp, ec);
+      return;
+    }
+  }
+  fs::rename(tmp, file, ec);
+  if (ec) PRINTDB("Can't write font index %s: %s", this->path % ec.message());
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*!
+   Persistent index of the font file and face index fontconfig matched each font
+   name to, so fonts can be opened without building the fontconfig font set.
+
+   The index is stored as a versioned text file, and is only used while the font
+   directories (including their subdirectories) and fontconfig configuration files
+   have the same modification times as when the index was written, and the
+   fontconfig version and language settings are unchanged. Otherwise it starts
+   out empty and is filled as fonts are looked up. New entries are written by
+   flush(), together with the state of the font directories recorded by scan().
+ */
+class FontIndex
+{
+public:
+  FontIndex(std::string path, std::vector<std::string> roots, std::vector<std::string> configFiles, std::string environment);
+
+  [[nodiscard]] bool lookup(const std::string& font, std::string& file, int& index) const;
+  // Adds a match, which is written by the next flush()
+  void insert(const std::string& font, const std::string& file, int index);
+  // Records the modification times of the font directories and configuration files
+  void scan();
+  // Writes the index file if matches were added since it was loaded or written
+  void flush();
+  [[nodiscard]] size_t size() const { return this->fonts.size(); }
+
+private:
+  bool load();
+  void save() const;
+
+  using stamp_t = std::pair<std::string, int64_t>; // path, modification time
+
+  std::string path;
+  std::vector<std::string> roots;
+  std::vector<std::string> configFiles;
+  std::string environment;
+  bool scanned{false};
+  bool dirty{false};
+  std::vector<stamp_t> dirs;
+  std::vector<stamp_t> confs;
+  std::map<std::string, std::pair<std::string, int>> fonts;
+};
@@ -40,6 +40,9 @@
 #include <vector>
 
 #include "utils/printutils.h"
+#include "core/CSGTreeOptimizer.h"
+#include "core/EvaluationSession.h"
+#include "Feature.h"
 #include "geometry/GeometryCache.h"
 #include "geometry/PolySet.h"
 #include "geometry/Polygon2d.h"
@@ -66,6 +69,9 @@ struct StatisticVisitor : public GeometryVisitor
   virtual void printCamera(const Camera& camera) = 0;
   virtual void printCacheStatistic() = 0;
   virtual void printRenderingTime(std::chrono::milliseconds) = 0;
+  virtual void printTreeOptimizer(const CSGTreeOptimizer& optimizer) = 0;
+  virtual void printMemoization(const EvaluationSession& session) = 0;
+  virtual void printGarbageCollection(const GarbageCollectionStatistics& statistics) = 0;
   virtual void finish() = 0;
 protected:
   bool is_enabled(const std::string& name) {
@@ -91,6 +97,9 @@ struct LogVisitor : public StatisticVisitor
   void printCamera(const Camera& camera) override;
   void printCacheStatistic() override;
   void printRenderingTime(std::chrono::milliseconds) override;
+  void printTreeOptimizer(const CSGTreeOptimizer& optimizer) override;
+  void printMemoization(const EvaluationSession& session) override;
+  void printGarbageCollection(const GarbageCollectionStatistics& statistics) override;
   void finish() override;
 private:
   void printBoundingBox3(const BoundingBox& bb);
@@ -115,6 +124,9 @@ struct StreamVisitor : public StatisticVisitor
   void printCamera(const Camera& camera) override;
   void printCacheStatistic() override;
   void printRenderingTime(std::chrono::milliseconds) override;
+  void printTreeOptimizer(const CSGTreeOptimizer& optimizer) override;
+  void printMemoization(const EvaluationSession& session) override;
+  void printGarbageCollection(const GarbageCollectionStatistics& statistics) override;
   void finish() override;
 private:
   nlohmann::json json;
@@ -190,6 +202,16 @@ void RenderStatistic::printRenderingTime()
   visitor.printRenderingTime(ms());
 }
 
+void RenderStatistic::setTreeOptimizer(const CSGTreeOptimizer *optimizer)
+{
+  treeOptimizer = optimizer;
+}
+
+void RenderStatistic::setEvaluationSession(const EvaluationSession *session)
+{
+  this->session = session;
+}
+
 void RenderStatistic::printAll(const std::shared_ptr<const Geometry>& geom, const Camera& camera, const std::vector<std::string>& options, const std::string& filename)
 {
   //bool is_log = false;
@@ -205,6 +227,13 @@ void RenderStatistic::printAll(const std::shared_ptr<const Geometry>& geom, cons
 
   visitor->printCacheStatistic();
   visitor->printRenderingTime(ms());
+  if (treeOptimizer) {
+    visitor->printTreeOptimizer(*treeOptimizer);
+  }
+  if (session) {
+    visitor->printMemoization(*session);
+    visitor->printGarbageCollection(session->contextMemoryManager().statistics());
+  }
   if (geom && !geom->isEmpty()) {
     geom->accept(*visitor);
   }
@@ -324,6 +353,53 @@ void LogVisitor::printRenderingTime(const std::chrono::milliseconds ms)
       (ms.count() % 1000));
 }
 
+void LogVisitor::printTreeOptimizer(const CSGTreeOptimizer& optimizer)
+{
+  if (is_enabled(RenderStatistic::CSG_OPTIMIZER)) {
+    LOG("CSG tree optimizer:");
+    LOG("   Flattened unions:    %1$6d", optimizer.count(CSGTreeOptimizer::Rewrite::FlattenUnion));
+    LOG("   Folded transforms:   %1$6d", optimizer.count(CSGTreeOptimizer::Rewrite::FoldTransform));
+    LOG("   Merged subtrahends:  %1$6d", optimizer.count(CSGTreeOptimizer::Rewrite::MergeSubtrahends));
+    LOG("   Removed empty nodes: %1$6d", optimizer.count(CSGTreeOptimizer::Rewrite::RemoveEmpty));
+    for (const auto& decision : optimizer.getDecisions()) {
+      LOG("   Line %1$d: %2$s (%3$s)", decision.line, CSGTreeOptimizer::describe(decision.rewrite), decision.node);
+    }
+  }
+}
+
+void LogVisitor::printMemoization(const EvaluationSession& session)
+{
+  if (is_enabled(RenderStatistic::MEMOIZATION)) {
+    if (Feature::ExperimentalModuleMemoization.is_enabled()) {
+      const auto& cache = session.moduleInstanceCache();
+      LOG("Module memoization:");
+      LOG("   Hits:       %1$6d", cache.hitCount());
+      LOG("   Misses:     %1$6d", cache.missCount());
+      LOG("   Entries:    %1$6d", cache.size());
+    }
+    if (Feature::ExperimentalFunctionMemoization.is_enabled()) {
+      const auto& cache = session.functionResultCache();
+      const auto lookups = cache.hitCount() + cache.missCount();
+      LOG("Function memoization:");
+      LOG("   Hits:       %1$6d (%2$.1f%%)", cache.hitCount(), lookups ? 100.0 * cache.hitCount() / lookups : 0.0);
+      LOG("   Misses:     %1$6d", cache.missCount());
+      LOG("   Entries:    %1$6d (%2$.2f MB)", cache.size(), cache.totalCost() / (1024.0 * 1024.0));
+    }
+  }
+}
+
+void LogVisitor::printGarbageCollection(const GarbageCollectionStatistics& statistics)
+{
+  if (is_enabled(RenderStatistic::GARBAGE_COLLECTION)) {
+    LOG("Garbage collection:");
+    LOG("   Minor collections: %1$6d", statistics.minorCollections);
+    LOG("   Major collections: %1$6d", statistics.majorCollections);
+    LOG("   Contexts freed:    %1$6d", statistics.contextsFreed);
+    LOG("   Total pause:       %1$.3f ms", statistics.totalPause.count() / 1000.0);
+    LOG("   Longest pause:     %1$.3f ms", statistics.maxPause.count() / 1000.0);
+  }
+}
+
 void LogVisitor::finish()
 {
 }
@@ -442,6 +518,57 @@ void StreamVisitor::printRenderingTime(const std::chrono::milliseconds ms)
   }
 }
 
+void StreamVisitor::printTreeOptimizer(const CSGTreeOptimizer& optimizer)
+{
+  if (is_enabled(RenderStatistic::CSG_OPTIMIZER)) {
+    nlohmann::json optimizerJson;
+    optimizerJson["flattened_unions"] = optimizer.count(CSGTreeOptimizer::Rewrite::FlattenUnion);
+    optimizerJson["folded_transforms"] = optimizer.count(CSGTreeOptimizer::Rewrite::FoldTransform);
+    optimizerJson["merged_subtrahends"] = optimizer.count(CSGTreeOptimizer::Rewrite::MergeSubtrahends);
+    optimizerJson["removed_empty_nodes"] = optimizer.count(CSGTreeOptimizer::Rewrite::RemoveEmpty);
+    nlohmann::json decisionsJson = nlohmann::json::array();
+    for (const auto& decision : optimizer.getDecisions()) {
+      nlohmann::json decisionJson;
+      decisionJson["rewrite"] = CSGTreeOptimizer::describe(decision.rewrite);
+      decisionJson["node"] = decision.node;
+      decisionJson["line"] = decision.line;
+      decisionsJson.push_back(decisionJson);
+    }
+    optimizerJson["decisions"] = decisionsJson;
+    json["csg_optimizer"] = optimizerJson;
+  }
+}
+
+void StreamVisitor::printMemoization(const EvaluationSession& session)
+{
+  if (is_enabled(RenderStatistic::MEMOIZATION)) {
+    nlohmann::json memoizationJson;
+    const auto& modules = session.moduleInstanceCache();
+    memoizationJson["modules"]["hits"] = modules.hitCount();
+    memoizationJson["modules"]["misses"] = modules.missCount();
+    memoizationJson["modules"]["entries"] = modules.size();
+    const auto& functions = session.functionResultCache();
+    memoizationJson["functions"]["hits"] = functions.hitCount();
+    memoizationJson["functions"]["misses"] = functions.missCount();
+    memoizationJson["functions"]["entries"] = functions.size();
+    memoizationJson["functions"]["bytes"] = functions.totalCost();
+    json["memoization"] = memoizationJson;
+  }
+}
+
+void StreamVisitor::printGarbageCollection(const GarbageCollectionStatistics& statistics)
+{
+  if (is_enabled(RenderStatistic::GARBAGE_COLLECTION)) {
+    nlohmann::json gcJson;
+    gcJson["minor_collections"] = statistics.minorCollections;
+    gcJson["major_collections"] = statistics.majorCollections;
+    gcJson["contexts_freed"] = statistics.contextsFreed;
+    gcJson["total_pause_us"] = statistics.totalPause.count();
+    gcJson["max_pause_us"] = statistics.maxPause.count();
+    json["garbage_collection"] = gcJson;
+  }
+}
+
 void StreamVisitor::finish()
 {
   stream << json;
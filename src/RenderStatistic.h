@@ -33,6 +33,9 @@
 #include "glview/Camera.h"
 #include "geometry/Geometry.h"
 
+class CSGTreeOptimizer;
+class EvaluationSession;
+
 /**
  * An utility class to collect and print rendering statistics for the given
  * geometry
@@ -46,6 +49,9 @@ public:
   constexpr static auto GEOMETRY = "geometry";
   constexpr static auto BOUNDING_BOX = "bounding-box";
   constexpr static auto AREA = "area";
+  constexpr static auto CSG_OPTIMIZER = "csg-optimizer";
+  constexpr static auto MEMOIZATION = "memoization";
+  constexpr static auto GARBAGE_COLLECTION = "garbage-collection";
 
   /**
    * Construct a statistic printer for the given geometry with current
@@ -74,6 +80,19 @@ public:
    */
   void printRenderingTime();
 
+  /**
+   * Include the rewrites done by the given optimizer in the statistic. The
+   * optimizer must outlive the calls to print functions.
+   */
+  void setTreeOptimizer(const CSGTreeOptimizer *optimizer);
+
+  /**
+   * Include the memoization hit rates and garbage collection statistics of
+   * the given session in the statistic.
+   * The session must outlive the calls to print functions.
+   */
+  void setEvaluationSession(const EvaluationSession *session);
+
   /**
    * Print all available statistic information.
    */
@@ -81,4 +100,6 @@ public:
 
 private:
   std::chrono::steady_clock::time_point begin;
+  const CSGTreeOptimizer *treeOptimizer{nullptr};
+  const EvaluationSession *session{nullptr};
 };
@@ -59,6 +59,14 @@ public:
 
   static std::shared_ptr<CSGNode> createCSGNode(OpenSCADOperator type, std::shared_ptr<CSGNode> left, std::shared_ptr<CSGNode> right);
 
+  // Memoized result of CSGTreeNormalizer
+  struct Normalized {
+    enum class State { NONE, SELF, REWRITTEN } state{State::NONE};
+    std::weak_ptr<CSGNode> term; // normalized term if REWRITTEN
+    size_t terms{0}; // number of leaves, 0 if the term normalized to nothing
+  };
+  Normalized normalized;
+
 private:
   CSGOperation(OpenSCADOperator type, const std::shared_ptr<CSGNode>& left, const std::shared_ptr<CSGNode>& right);
   OpenSCADOperator type;
@@ -47,9 +47,7 @@ std::shared_ptr<CSGNode> CSGTreeEvaluator::buildCSGTree(const AbstractNode& node
 
 void CSGTreeEvaluator::applyBackgroundAndHighlight(State& /*state*/, const AbstractNode& node)
 {
-  for (const auto& chnode : this->visitedchildren[node.index()]) {
-    std::shared_ptr<CSGNode> t(this->stored_term[chnode->index()]);
-    this->stored_term.erase(chnode->index());
+  for (const auto& [chnode, t] : this->visitedchildren[node.index()]) {
     if (t) {
       if (t->isBackground()) this->backgroundNodes.push_back(t);
       if (t->isHighlight()) this->highlightNodes.push_back(t);
@@ -66,9 +64,7 @@ void CSGTreeEvaluator::applyToChildren(State& state, const AbstractNode& node, O
   }
 
   std::shared_ptr<CSGNode> t1;
-  for (const auto& chnode : vc) {
-    std::shared_ptr<CSGNode> t2(this->stored_term[chnode->index()]);
-    this->stored_term.erase(chnode->index());
+  for (const auto& [chnode, t2] : vc) {
     if (t2 && !t1) {
       t1 = t2;
     } else if (t2 && t1) {
@@ -161,9 +157,9 @@ Response CSGTreeEvaluator::visit(State& state, const class ListNode& node)
       if (node.modinst->isBackground()) state.setBackground(true);
     }
     if (state.isPostfix()) {
-      for (auto &chnode : this->visitedchildren[node.index()]) {
-        addToParent(state, *chnode);
-      }
+      auto& parentchildren = this->visitedchildren[state.parent()->index()];
+      parentchildren.splice(parentchildren.end(), this->visitedchildren[node.index()]);
+      this->visitedchildren.erase(node.index());
     }
     return Response::ContinueTraversal;
   } else {
@@ -349,6 +345,12 @@ void CSGTreeEvaluator::addToParent(const State& state, const AbstractNode& node)
 {
   this->visitedchildren.erase(node.index());
   if (state.parent()) {
-    this->visitedchildren[state.parent()->index()].push_back(node.shared_from_this());
+    auto term = this->stored_term.find(node.index());
+    if (term != this->stored_term.end()) {
+      this->visitedchildren[state.parent()->index()].emplace_back(node.shared_from_this(), std::move(term->second));
+      this->stored_term.erase(term);
+    } else {
+      this->visitedchildren[state.parent()->index()].emplace_back(node.shared_from_this(), nullptr);
+    }
   }
 }
@@ -2,6 +2,7 @@
 
 #include <map>
 #include <list>
+#include <utility>
 #include <vector>
 #include <cstddef>
 #include "core/NodeVisitor.h"
@@ -52,7 +53,9 @@ private:
                                                   const AbstractNode& node);
   void applyBackgroundAndHighlight(State& state, const AbstractNode& node);
 
-  using ChildList = std::list<std::shared_ptr<const AbstractNode>>;
+  // The term of each child moves into its parent's list when the child is done,
+  // since a node shared by several parents is visited once per occurrence.
+  using ChildList = std::list<std::pair<std::shared_ptr<const AbstractNode>, std::shared_ptr<CSGNode>>>;
   std::map<int, ChildList> visitedchildren;
 
 protected:
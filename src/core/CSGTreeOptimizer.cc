@@ -0,0 +1,259 @@
+#include "core/CSGTreeOptimizer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "Feature.h"
+#include "core/ColorNode.h"
+#include "core/CsgOpNode.h"
+#include "core/ModuleInstantiation.h"
+#include "core/TransformNode.h"
+#include "core/enums.h"
+#include "core/node.h"
+#include "geometry/linalg.h"
+
+namespace {
+
+bool isBackground(const AbstractNode& node)
+{
+  return node.modinst->isBackground();
+}
+
+bool isList(const AbstractNode& node)
+{
+  return dynamic_cast<const ListNode *>(&node) != nullptr;
+}
+
+bool isCsgOp(const AbstractNode& node, OpenSCADOperator type)
+{
+  const auto *csgop = dynamic_cast<const CsgOpNode *>(&node);
+  return csgop && csgop->type == type;
+}
+
+/*!
+   Nodes evaluated as a plain union of their children. With lazy unions, the
+   top-level children are kept apart, so the root node doesn't count.
+ */
+bool isUnion(const AbstractNode& node)
+{
+  if (dynamic_cast<const RootNode *>(&node)) return !Feature::ExperimentalLazyUnion.is_enabled();
+  return dynamic_cast<const GroupNode *>(&node) || isCsgOp(node, OpenSCADOperator::UNION);
+}
+
+/*!
+   Nodes which union their children before applying an operation to the result.
+ */
+bool unionsChildren(const AbstractNode& node)
+{
+  return isUnion(node) || dynamic_cast<const TransformNode *>(&node) || dynamic_cast<const ColorNode *>(&node);
+}
+
+/*!
+   True if the node can't produce any geometry, regardless of its ancestors.
+   Lists are never empty in that sense, since they pass their children on to
+   the parent rather than acting as a single operand.
+ */
+bool isProvablyEmpty(const AbstractNode& node)
+{
+  if (isBackground(node) || isList(node) || dynamic_cast<const RootNode *>(&node)) return false;
+  return node.children.empty() && (unionsChildren(node) || dynamic_cast<const CsgOpNode *>(&node));
+}
+
+/*!
+   Applying the 2D part of the combined matrix equals applying the 2D parts of
+   both matrices, unless the inner matrix moves points out of the XY plane and
+   the outer matrix moves them back.
+ */
+bool canFold(const Transform3d& outer, const Transform3d& inner)
+{
+  if (matrix_contains_infinity(outer) || matrix_contains_nan(outer) ||
+      matrix_contains_infinity(inner) || matrix_contains_nan(inner)) {
+    return false;
+  }
+  return (outer(0, 2) == 0 && outer(1, 2) == 0) ||
+         (inner(2, 0) == 0 && inner(2, 1) == 0 && inner(2, 3) == 0);
+}
+
+} // namespace
+
+std::shared_ptr<AbstractNode> CSGTreeOptimizer::optimize(const std::shared_ptr<AbstractNode>& root)
+{
+  this->decisions.clear();
+  this->counts.fill(0);
+  this->emptied.clear();
+  this->optimized.clear();
+  if (!root) return root;
+  return optimizeNode(root, true);
+}
+
+const char *CSGTreeOptimizer::describe(Rewrite rewrite)
+{
+  switch (rewrite) {
+  case Rewrite::FlattenUnion: return "flattened union";
+  case Rewrite::FoldTransform: return "folded transform";
+  case Rewrite::MergeSubtrahends: return "merged subtrahends";
+  case Rewrite::RemoveEmpty: return "removed empty node";
+  }
+  return "";
+}
+
+std::shared_ptr<AbstractNode> CSGTreeOptimizer::optimizeNode(const std::shared_ptr<AbstractNode>& node, bool isRoot)
+{
+  auto it = this->optimized.find(node);
+  if (it != this->optimized.end()) return it->second;
+  auto result = rewriteNode(node, isRoot);
+  this->optimized.emplace(node, result);
+  return result;
+}
+
+std::shared_ptr<AbstractNode> CSGTreeOptimizer::rewriteNode(const std::shared_ptr<AbstractNode>& node, bool isRoot)
+{
+  if (isBackground(*node)) return node;
+  for (auto& child : node->children) {
+    child = optimizeNode(child, false);
+  }
+
+  if (isUnion(*node)) {
+    flattenUnion(*node);
+    // A union of a single object is that object
+    if (!isRoot && node->children.size() == 1) {
+      const auto& child = node->children.front();
+      if (!isList(*child) && !isBackground(*child)) {
+        record(Rewrite::FlattenUnion, *node);
+        return child;
+      }
+    }
+    return node;
+  }
+  if (unionsChildren(*node)) {
+    removeEmptyChildren(*node);
+    if (dynamic_cast<const TransformNode *>(node.get())) return foldTransform(node);
+    return node;
+  }
+  if (isCsgOp(*node, OpenSCADOperator::DIFFERENCE)) return optimizeDifference(node);
+  if (isCsgOp(*node, OpenSCADOperator::INTERSECTION)) return optimizeIntersection(node);
+  return node;
+}
+
+/*!
+   Splices the children of nested unions into the given union node, dropping
+   empty children.
+ */
+void CSGTreeOptimizer::flattenUnion(AbstractNode& node)
+{
+  std::vector<std::shared_ptr<AbstractNode>> children;
+  children.reserve(node.children.size());
+  for (auto& child : node.children) {
+    if (removeIfEmpty(*child)) continue;
+    if (isUnion(*child) && !isBackground(*child)) {
+      // Children were optimized first, so nested unions are already flat
+      record(Rewrite::FlattenUnion, *child);
+      children.insert(children.end(), child->children.begin(), child->children.end());
+    } else {
+      children.push_back(std::move(child));
+    }
+  }
+  node.children = std::move(children);
+}
+
+void CSGTreeOptimizer::removeEmptyChildren(AbstractNode& node)
+{
+  auto& children = node.children;
+  children.erase(std::remove_if(children.begin(), children.end(), [this](const std::shared_ptr<AbstractNode>& child) {
+    return removeIfEmpty(*child);
+  }), children.end());
+}
+
+/*!
+   The first child is the minuend, unless it is a list or a background object,
+   in which case the actual minuend is only known after evaluation and the
+   node is left alone.
+ */
+std::shared_ptr<AbstractNode> CSGTreeOptimizer::optimizeDifference(const std::shared_ptr<AbstractNode>& node)
+{
+  auto& children = node->children;
+  if (children.empty()) return node;
+  const auto& minuend = children.front();
+  if (isList(*minuend) || isBackground(*minuend)) return node;
+  if (isProvablyEmpty(*minuend)) return makeEmpty(node);
+
+  children.erase(std::remove_if(children.begin() + 1, children.end(), [this](const std::shared_ptr<AbstractNode>& child) {
+    return removeIfEmpty(*child);
+  }), children.end());
+
+  // Subtracting the union of the subtrahends runs a single difference against
+  // the (usually larger) minuend, while the subtrahends themselves tend to be
+  // small and disjoint, which makes their union cheap.
+  if (children.size() > 2) {
+    auto subtrahends = std::make_shared<CsgOpNode>(node->modinst, OpenSCADOperator::UNION);
+    subtrahends->children.assign(children.begin() + 1, children.end());
+    flattenUnion(*subtrahends);
+    children.resize(1);
+    children.push_back(subtrahends);
+    record(Rewrite::MergeSubtrahends, *node);
+  }
+  return node;
+}
+
+std::shared_ptr<AbstractNode> CSGTreeOptimizer::optimizeIntersection(const std::shared_ptr<AbstractNode>& node)
+{
+  for (const auto& child : node->children) {
+    if (isProvablyEmpty(*child)) return makeEmpty(node);
+  }
+  return node;
+}
+
+/*!
+   Replaces a transformation whose only child is another transformation
+   with a single transformation. Nested chains were folded bottom-up already.
+ */
+std::shared_ptr<AbstractNode> CSGTreeOptimizer::foldTransform(const std::shared_ptr<AbstractNode>& node)
+{
+  if (node->children.size() != 1) return node;
+  const auto outer = std::static_pointer_cast<TransformNode>(node);
+  const auto inner = std::dynamic_pointer_cast<TransformNode>(node->children.front());
+  if (!inner || isBackground(*inner) || !canFold(outer->matrix, inner->matrix)) return node;
+
+  auto folded = std::make_shared<TransformNode>(outer->modinst, outer->verbose_name());
+  folded->matrix = outer->matrix * inner->matrix;
+  folded->children = inner->children;
+  record(Rewrite::FoldTransform, *outer);
+  return folded;
+}
+
+/*!
+   Drops the children of a node which can't produce any geometry, so that it
+   becomes provably empty itself.
+ */
+std::shared_ptr<AbstractNode> CSGTreeOptimizer::makeEmpty(const std::shared_ptr<AbstractNode>& node)
+{
+  node->children.clear();
+  record(Rewrite::RemoveEmpty, *node);
+  this->emptied.insert(node.get());
+  return node;
+}
+
+/*!
+   Returns true if the given child should be removed from its parent. Nodes
+   emptied by makeEmpty() were already recorded.
+ */
+bool CSGTreeOptimizer::removeIfEmpty(const AbstractNode& child)
+{
+  if (!isProvablyEmpty(child)) return false;
+  if (!this->emptied.count(&child)) record(Rewrite::RemoveEmpty, child);
+  return true;
+}
+
+void CSGTreeOptimizer::record(Rewrite rewrite, const AbstractNode& node)
+{
+  auto name = node.verbose_name();
+  if (name.empty()) name = node.name();
+  this->decisions.push_back({rewrite, std::move(name), node.modinst->location().firstLine()});
+  ++this->counts[static_cast<size_t>(rewrite)];
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class AbstractNode;
+
+/*!
+   Rewrites a node tree into an equivalent tree which is cheaper to evaluate
+   into geometry:
+
+   - Nested unions (group and union nodes) are flattened into their parent union,
+     and unions with a single child are replaced by that child.
+   - Chains of transformations are folded into a single transformation.
+   - difference(A, B1, ..., Bn) becomes difference(A, union(B1, ..., Bn)), so the
+     minuend takes part in a single difference operation.
+   - Branches which can't produce any geometry (empty groups, intersections with an
+     empty operand, differences with an empty minuend) are removed.
+
+   The tree is rewritten in place, so it must not be used for anything depending
+   on its original structure (e.g. CSG export) afterwards. Nodes which are not
+   evaluated into geometry (background modifier) are left alone. Subtrees shared
+   by several parents (see ModuleInstanceCache) are rewritten once.
+
+   NB! Folding transformations changes floating point rounding of the results, and
+   trees which mix 2D and 3D children (which is reported as a warning) may
+   have different children ignored after flattening.
+ */
+class CSGTreeOptimizer
+{
+public:
+  enum class Rewrite { FlattenUnion, FoldTransform, MergeSubtrahends, RemoveEmpty };
+  constexpr static size_t REWRITE_COUNT = 4;
+
+  struct Decision {
+    Rewrite rewrite;
+    std::string node; // Verbose name of the rewritten node
+    int line;         // Source line of the rewritten node, 0 if unknown
+  };
+
+  std::shared_ptr<AbstractNode> optimize(const std::shared_ptr<AbstractNode>& root);
+
+  // Rewrites in the order they were applied
+  [[nodiscard]] const std::vector<Decision>& getDecisions() const { return this->decisions; }
+  [[nodiscard]] size_t count(Rewrite rewrite) const { return this->counts[static_cast<size_t>(rewrite)]; }
+  static const char *describe(Rewrite rewrite);
+
+private:
+  std::shared_ptr<AbstractNode> optimizeNode(const std::shared_ptr<AbstractNode>& node, bool isRoot);
+  std::shared_ptr<AbstractNode> rewriteNode(const std::shared_ptr<AbstractNode>& node, bool isRoot);
+  void flattenUnion(AbstractNode& node);
+  void removeEmptyChildren(AbstractNode& node);
+  std::shared_ptr<AbstractNode> optimizeDifference(const std::shared_ptr<AbstractNode>& node);
+  std::shared_ptr<AbstractNode> optimizeIntersection(const std::shared_ptr<AbstractNode>& node);
+  std::shared_ptr<AbstractNode> foldTransform(const std::shared_ptr<AbstractNode>& node);
+  std::shared_ptr<AbstractNode> makeEmpty(const std::shared_ptr<AbstractNode>& node);
+  bool removeIfEmpty(const AbstractNode& child);
+  void record(Rewrite rewrite, const AbstractNode& node);
+
+  std::vector<Decision> decisions;
+  std::array<size_t, REWRITE_COUNT> counts{};
+  std::unordered_set<const AbstractNode *> emptied;
+  // Keys are kept alive, so their addresses can't be reused by new nodes
+  std::unordered_map<std::shared_ptr<AbstractNode>, std::shared_ptr<AbstractNode>> optimized;
+};
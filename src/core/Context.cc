@@ -42,7 +42,7 @@ Context::Context(EvaluationSession *session) :
 {}
 
 Context::Context(const std::shared_ptr<const Context>& parent) :
-  ContextFrame(parent->evaluation_session),
+  ContextFrame(ParallelEvaluation::sessionForThread(parent->evaluation_session)),
   parent(parent)
 {}
 
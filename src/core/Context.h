@@ -9,6 +9,7 @@
 #include "core/ContextFrame.h"
 #include "core/AST.h"
 #include "core/ContextMemoryManager.h"
+#include "core/ParallelEvaluation.h"
 
 /**
  * Local handle to a all context objects. This is used to maintain the
@@ -77,7 +78,7 @@ public:
 
   template <typename C, typename ... T>
   static ContextHandle<C> create(T&& ... t) {
-    return ContextHandle<C>{std::shared_ptr<C>(new C(std::forward<T>(t)...))};
+    return ContextHandle<C>{allocate<C>(std::forward<T>(t)...)};
   }
 
   virtual void init() { }
@@ -102,6 +103,29 @@ public:
 protected:
   std::shared_ptr<const Context> parent;
 
+private:
+  static EvaluationSession *session_of(EvaluationSession *session) { return session; }
+  static EvaluationSession *session_of(const std::shared_ptr<const Context>& parent) {
+    return ParallelEvaluation::sessionForThread(parent->session());
+  }
+
+  // Contexts and their reference counts live in the session's arena. The first
+  // constructor argument is either the session or the parent context.
+  template <typename C, typename First, typename ... T>
+  static std::shared_ptr<C> allocate(First&& first, T&& ... t) {
+    static_assert(alignof(C) <= EvaluationArena::GRANULARITY, "Context is over-aligned for the arena");
+    EvaluationArena& arena = session_of(first)->arena();
+    void *memory = arena.allocate(sizeof(C));
+    C *context;
+    try {
+      context = new (memory) C(std::forward<First>(first), std::forward<T>(t)...);
+    } catch (...) {
+      arena.deallocate(memory, sizeof(C));
+      throw;
+    }
+    return std::shared_ptr<C>(context, ArenaDeleter<C>{&arena}, ArenaAllocator<C>(arena));
+  }
+
   bool accountingAdded = false;   // avoiding bad accounting when exception threw in constructor issue #3871
 
 public:
@@ -40,6 +40,8 @@ public:
   void apply_variables(ContextFrame&& other);
 
   static bool is_config_variable(const std::string& name);
+  const ValueMap& lexical_variable_map() const { return lexical_variables; }
+  const ValueMap& config_variable_map() const { return config_variables; }
 
   EvaluationSession *session() const { return evaluation_session; }
   const std::string& documentRoot() const { return evaluation_session->documentRoot(); }
@@ -27,7 +27,9 @@
 #include "core/ContextMemoryManager.h"
 
 #include <variant>
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <utility>
 #include <memory>
 #include <deque>
@@ -207,11 +209,15 @@ static std::vector<Context *> findRootContexts(const std::vector<std::shared_ptr
 
 
 /*
- * Finds all contexts reachable from a set of root contexts.
+ * Finds all managed contexts reachable from a set of root contexts.
+ *
+ * Contexts which aren't managed are not explored: any reference from them
+ * to a managed context already makes the latter a root context.
  *
  * Implemented as a breadth first search to save on stack space.
  */
-static std::unordered_set<const Context *> findReachableContexts(const std::vector<Context *>& rootContexts)
+static std::unordered_set<const Context *> findReachableContexts(const std::vector<Context *>& rootContexts,
+                                                                 const std::unordered_set<const Context *>& managed)
 {
   std::unordered_set<ValueIdentifier> valuesSeen;
   std::unordered_set<const Context *> contextsSeen;
@@ -230,6 +236,9 @@ static std::unordered_set<const Context *> findReachableContexts(const std::vect
       }
     };
   auto visitContext = [&](const Context *context) {
+      if (!managed.count(context)) {
+        return;
+      }
       if (!contextsSeen.count(context)) {
         contextsSeen.insert(context);
         contextQueue.push_back(context);
@@ -277,9 +286,12 @@ static std::unordered_set<const Context *> findReachableContexts(const std::vect
 
 
 /*
- * Clean up all unreachable contexts.
+ * Clean up all unreachable contexts among managedContexts, leaving the
+ * others in it. References from contexts which are not in managedContexts
+ * count as references from the evaluation stack, so it can be a subset of
+ * all contexts. Returns the number of contexts cleaned up.
  */
-static void collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
+static size_t collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
 {
   /*
    * Garbage collection consists of three phases.
@@ -312,18 +324,24 @@ static void collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
 
   std::vector<Context *> rootContexts = findRootContexts(allContexts);
 
-  std::unordered_set<const Context *> reachableContexts = findReachableContexts(rootContexts);
+  std::unordered_set<const Context *> managed;
+  for (const std::shared_ptr<Context>& context : allContexts) {
+    managed.insert(context.get());
+  }
+  std::unordered_set<const Context *> reachableContexts = findReachableContexts(rootContexts, managed);
 
 #ifdef DEBUG
   std::vector<std::weak_ptr<Context>> removedContexts;
 #endif
 
+  size_t removed = 0;
   managedContexts.clear();
   for (std::shared_ptr<Context>& context : allContexts) {
     if (reachableContexts.count(context.get())) {
       managedContexts.emplace_back(context);
     } else {
       context->clear();
+      ++removed;
 #ifdef DEBUG
       removedContexts.emplace_back(context);
 #endif
@@ -349,15 +367,17 @@ static void collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
     assert(context.expired());
   }
 #endif
+  return removed;
 }
 
 
 
 ContextMemoryManager::~ContextMemoryManager()
 {
-  collectGarbage(managedContexts);
-  assert(managedContexts.empty());
-  assert(heapSizeAccounting.size() == 0);
+  oldContexts.insert(oldContexts.end(), youngContexts.begin(), youngContexts.end());
+  youngContexts.clear();
+  collectGarbage(oldContexts);
+  assert(oldContexts.empty());
 }
 
 void ContextMemoryManager::addContext(const std::shared_ptr<Context>& context)
@@ -371,10 +391,17 @@ void ContextMemoryManager::addContext(const std::shared_ptr<Context>& context)
    * right away.
    */
   if (context.use_count() > 1) {
-    managedContexts.emplace_back(context);
+    youngContexts.emplace_back(context);
 
     if (heapSizeAccounting.size() >= nextGarbageCollectSize) {
-      collectGarbage(managedContexts);
+      /*
+       * Most of the growth is usually short-lived cycles, which a collection
+       * of the young generation frees much more cheaply. Only collect
+       * everything if the heap is still too large after that.
+       */
+      collectYoungGeneration();
+      if (heapSizeAccounting.size() < nextGarbageCollectSize) return;
+      collectAll();
       /*
        * The cost of a garbage collection run is proportional to the heap
        * size. By scheduling the next run at twice the *remaining* heap size,
@@ -385,6 +412,48 @@ void ContextMemoryManager::addContext(const std::shared_ptr<Context>& context)
        * (i.e. waste is at most a factor 2 overhead).
        */
       nextGarbageCollectSize = heapSizeAccounting.size() * 2;
+    } else if (youngContexts.size() >= YOUNG_GENERATION_SIZE) {
+      collectYoungGeneration();
     }
   }
 }
+
+void ContextMemoryManager::collectYoungGeneration()
+{
+  auto start = std::chrono::steady_clock::now();
+  gcStatistics.contextsFreed += collectGarbage(youngContexts);
+  oldContexts.insert(oldContexts.end(), youngContexts.begin(), youngContexts.end());
+  youngContexts.clear();
+
+  /*
+   * Most old contexts are freed by reference counting rather than by a
+   * collection. Drop them from the list once it has doubled, so the list
+   * stays proportional to the live old contexts.
+   */
+  if (oldContexts.size() >= 2 * oldContextsAfterPruning + YOUNG_GENERATION_SIZE) {
+    oldContexts.erase(std::remove_if(oldContexts.begin(), oldContexts.end(),
+                                     [](const std::weak_ptr<Context>& context) { return context.expired(); }),
+                      oldContexts.end());
+    oldContextsAfterPruning = oldContexts.size();
+  }
+  ++gcStatistics.minorCollections;
+  recordPause(start);
+}
+
+void ContextMemoryManager::collectAll()
+{
+  auto start = std::chrono::steady_clock::now();
+  oldContexts.insert(oldContexts.end(), youngContexts.begin(), youngContexts.end());
+  youngContexts.clear();
+  gcStatistics.contextsFreed += collectGarbage(oldContexts);
+  oldContextsAfterPruning = oldContexts.size();
+  ++gcStatistics.majorCollections;
+  recordPause(start);
+}
+
+void ContextMemoryManager::recordPause(std::chrono::steady_clock::time_point start)
+{
+  auto pause = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  gcStatistics.totalPause += pause;
+  gcStatistics.maxPause = std::max(gcStatistics.maxPause, pause);
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <memory>
 #include <vector>
@@ -31,18 +32,51 @@ private:
   size_t count = 0;
 };
 
+struct GarbageCollectionStatistics
+{
+  size_t minorCollections = 0;
+  size_t majorCollections = 0;
+  size_t contextsFreed = 0;
+  std::chrono::microseconds totalPause{0};
+  std::chrono::microseconds maxPause{0};
+};
+
+/*
+ * Frees contexts which are kept alive only by reference cycles.
+ *
+ * Contexts are collected in two generations. Contexts which might be part
+ * of a cycle start out young, and the young generation is collected every
+ * YOUNG_GENERATION_SIZE such contexts, treating any references from old
+ * contexts as live. Survivors are promoted to the old generation, and
+ * both generations are only collected together once the heap has grown to
+ * twice its size after the last such collection. This keeps pauses short,
+ * as the long-lived contexts and values of an evaluation are not scanned
+ * again on every collection.
+ */
 class ContextMemoryManager
 {
 public:
+  // The accounting is owned by the session's EvaluationArena
+  ContextMemoryManager(HeapSizeAccounting& accounting) : heapSizeAccounting(accounting) {}
   ~ContextMemoryManager();
 
   void addContext(const std::shared_ptr<Context>& context);
   void releaseContext() { heapSizeAccounting.removeContext(); }
 
   HeapSizeAccounting& accounting() { return heapSizeAccounting; }
+  [[nodiscard]] const GarbageCollectionStatistics& statistics() const { return gcStatistics; }
+
+  constexpr static size_t YOUNG_GENERATION_SIZE = 4096;
 
 private:
-  std::vector<std::weak_ptr<Context>> managedContexts;
-  HeapSizeAccounting heapSizeAccounting;
+  void collectYoungGeneration();
+  void collectAll();
+  void recordPause(std::chrono::steady_clock::time_point start);
+
+  std::vector<std::weak_ptr<Context>> youngContexts;
+  std::vector<std::weak_ptr<Context>> oldContexts;
+  size_t oldContextsAfterPruning = 0;
+  HeapSizeAccounting& heapSizeAccounting;
   size_t nextGarbageCollectSize = 0;
+  GarbageCollectionStatistics gcStatistics;
 };
@@ -83,6 +83,20 @@ void DrawingCallback::add_vertex(const Vector2d& v)
   this->outline.vertices.push_back(size * (v + offset + advance));
 }
 
+void DrawingCallback::add_outlines(const Polygon2d& glyph)
+{
+  for (const auto& o : glyph.outlines()) {
+    if (this->outline.vertices.size() > 0) {
+      this->polygon->addOutline(this->outline);
+      this->outline.vertices.clear();
+    }
+    this->outline.vertices.reserve(o.vertices.size());
+    for (const auto& v : o.vertices) {
+      add_vertex(v);
+    }
+  }
+}
+
 void DrawingCallback::move_to(const Vector2d& to)
 {
   if (this->outline.vertices.size() > 0) {
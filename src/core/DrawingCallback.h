@@ -51,6 +51,8 @@ public:
   void line_to(const Vector2d& to);
   void curve_to(const Vector2d& c1, const Vector2d& to);
   void curve_to(const Vector2d& c1, const Vector2d& c2, const Vector2d& to);
+  // Adds the outlines of a glyph flattened at unit size without offset
+  void add_outlines(const Polygon2d& glyph);
 private:
   Vector2d pen;
   Vector2d offset;
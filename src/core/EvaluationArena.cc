@@ -0,0 +1,53 @@
+#include "core/EvaluationArena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+void EvaluationArena::release()
+{
+  released = true;
+  // Otherwise the last deallocate() frees the arena
+  if (in_use == 0) delete this;
+}
+
+void *EvaluationArena::allocate(size_t size)
+{
+  if (size > MAX_SIZE) return ::operator new(size);
+
+  const size_t size_class = sizeClass(size);
+  in_use += size_class * GRANULARITY;
+  peak = std::max(peak, in_use);
+
+  if (FreeBlock *block = free_lists[size_class]) {
+    free_lists[size_class] = block->next;
+    return block;
+  }
+  const size_t block_size = size_class * GRANULARITY;
+  if (static_cast<size_t>(chunk_end - chunk_pos) < block_size) {
+    // The rest of the current chunk is left unused, it's less than MAX_SIZE
+    chunks.emplace_back(new char[CHUNK_SIZE]);
+    chunk_pos = chunks.back().get();
+    chunk_end = chunk_pos + CHUNK_SIZE;
+  }
+  void *ptr = chunk_pos;
+  chunk_pos += block_size;
+  return ptr;
+}
+
+void EvaluationArena::deallocate(void *ptr, size_t size)
+{
+  if (size > MAX_SIZE) return ::operator delete(ptr);
+
+  const size_t size_class = sizeClass(size);
+  assert(in_use >= size_class * GRANULARITY);
+  in_use -= size_class * GRANULARITY;
+
+  auto *block = static_cast<FreeBlock *>(ptr);
+  block->next = free_lists[size_class];
+  free_lists[size_class] = block;
+
+  if (released && in_use == 0) delete this;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "core/ContextMemoryManager.h"
+
+/*!
+   Pool allocator for the small, short-lived objects of an EvaluationSession:
+   contexts, vector values and their reference counts.
+
+   Memory is carved out of large chunks and kept on per-size free lists when
+   released, so the many contexts created and dropped by function calls, let()
+   and for() reuse the same memory instead of going through the heap.
+
+   Objects are freed individually when their last reference goes away, so
+   values which escape the frame that created them need no special handling.
+   The session releases its arena when it is destroyed, but the chunks are
+   only freed once the last object allocated from them is gone as well, so
+   vectors which outlive the session stay valid. The heap size accounting of
+   the session lives here for the same reason, as vectors update it when they
+   are released.
+
+   An arena is not thread safe, objects must be allocated and released by one
+   thread at a time.
+ */
+class EvaluationArena
+{
+public:
+  struct Release {
+    void operator()(EvaluationArena *arena) const { arena->release(); }
+  };
+  using Handle = std::unique_ptr<EvaluationArena, Release>;
+
+  static Handle create() { return Handle(new EvaluationArena()); }
+  EvaluationArena(const EvaluationArena&) = delete;
+  EvaluationArena& operator=(const EvaluationArena&) = delete;
+
+  void *allocate(size_t size);
+  // Frees the arena if it was released and this was its last object
+  void deallocate(void *ptr, size_t size);
+
+  HeapSizeAccounting& accounting() { return heap_size_accounting; }
+
+  [[nodiscard]] size_t bytesInUse() const { return in_use; }
+  [[nodiscard]] size_t peakBytesInUse() const { return peak; }
+  [[nodiscard]] size_t bytesReserved() const { return chunks.size() * CHUNK_SIZE; }
+
+  constexpr static size_t GRANULARITY = alignof(std::max_align_t);
+  // Larger allocations go to the heap
+  constexpr static size_t MAX_SIZE = 512;
+  constexpr static size_t CHUNK_SIZE = 64 * 1024;
+
+private:
+  EvaluationArena() = default;
+  ~EvaluationArena() = default;
+  void release();
+
+  struct FreeBlock {
+    FreeBlock *next;
+  };
+
+  static size_t sizeClass(size_t size) { return (size + GRANULARITY - 1) / GRANULARITY; }
+
+  std::array<FreeBlock *, MAX_SIZE / GRANULARITY + 1> free_lists{};
+  std::vector<std::unique_ptr<char[]>> chunks;
+  char *chunk_pos = nullptr;
+  char *chunk_end = nullptr;
+  size_t in_use = 0;
+  size_t peak = 0;
+  HeapSizeAccounting heap_size_accounting;
+  bool released = false;
+};
+
+// Standard allocator interface to an EvaluationArena, e.g. for shared_ptr control blocks
+template <typename T>
+class ArenaAllocator
+{
+public:
+  using value_type = T;
+
+  ArenaAllocator(EvaluationArena& arena) : arena(&arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+  T *allocate(size_t n) {
+    if (alignof(T) > EvaluationArena::GRANULARITY) return static_cast<T *>(::operator new(n * sizeof(T)));
+    return static_cast<T *>(arena->allocate(n * sizeof(T)));
+  }
+  void deallocate(T *ptr, size_t n) {
+    if (alignof(T) > EvaluationArena::GRANULARITY) return ::operator delete(ptr);
+    arena->deallocate(ptr, n * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+  template <typename U> friend class ArenaAllocator;
+  EvaluationArena *arena;
+};
+
+// Destroys an object created by placement new in an EvaluationArena
+template <typename T>
+struct ArenaDeleter {
+  EvaluationArena *arena;
+  void operator()(T *ptr) const {
+    ptr->~T();
+    arena->deallocate(ptr, sizeof(T));
+  }
+};
@@ -28,10 +28,14 @@
 
 #include <cassert>
 #include <cstddef>
+#include <map>
+#include <memory>
 #include <string>
 
 #include "core/AST.h"
 #include "core/ContextFrame.h"
+#include "core/MemoKey.h"
+#include "core/ParallelEvaluation.h"
 #include "utils/printutils.h"
 
 size_t EvaluationSession::push_frame(ContextFrame *frame)
@@ -53,7 +57,39 @@ void EvaluationSession::pop_frame(size_t index)
   assert(stack.size() == index);
 }
 
-boost::optional<const Value&> EvaluationSession::try_lookup_special_variable(const std::string& name) const
+EvaluationSession& EvaluationSession::workerSession(size_t index)
+{
+  if (index >= worker_sessions.size()) worker_sessions.resize(index + 1);
+  if (!worker_sessions[index]) {
+    worker_sessions[index] = std::make_unique<EvaluationSession>(document_root, this);
+  }
+  return *worker_sessions[index];
+}
+
+void EvaluationSession::add_special_variables(MemoKey& key) const
+{
+  // Frames higher up the stack shadow lower ones, and the key must not depend
+  // on hash map ordering.
+  std::map<std::string, const Value *> variables;
+  for (const auto *frame : stack) {
+    for (const auto& variable : frame->config_variable_map()) {
+      variables[variable.first] = &variable.second;
+    }
+  }
+  variables.erase("$parent_modules");
+  for (const auto& variable : variables) {
+    key.add(variable.first);
+    key.add(*variable.second);
+  }
+}
+
+void EvaluationSession::record_impure_operation() const
+{
+  ParallelEvaluation::requireSequential();
+  ++impure_operations;
+}
+
+boost::optional<const Value&> EvaluationSession::find_special_variable(const std::string& name) const
 {
   for (auto it = stack.crbegin(); it != stack.crend(); ++it) {
     boost::optional<const Value&> result = (*it)->lookup_local_variable(name);
@@ -61,9 +97,22 @@ boost::optional<const Value&> EvaluationSession::try_lookup_special_variable(con
       return result;
     }
   }
+  if (parent) return parent->find_special_variable(name);
   return boost::none;
 }
 
+boost::optional<const Value&> EvaluationSession::try_lookup_special_variable(const std::string& name) const
+{
+  if (name == "$parent_modules") {
+    record_impure_operation();
+  }
+  boost::optional<const Value&> result = find_special_variable(name);
+  if (function_result_cache.isRecording()) {
+    function_result_cache.recordRead(name, result);
+  }
+  return result;
+}
+
 const Value& EvaluationSession::lookup_special_variable(const std::string& name, const Location& loc) const
 {
   boost::optional<const Value&> result = try_lookup_special_variable(name);
@@ -82,6 +131,7 @@ boost::optional<CallableFunction> EvaluationSession::lookup_special_function(con
       return result;
     }
   }
+  if (parent) return parent->lookup_special_function(name, loc);
   LOG(message_group::Warning, loc, documentRoot(), "Ignoring unknown function '%1$s'", name);
   return boost::none;
 }
@@ -94,6 +144,7 @@ boost::optional<InstantiableModule> EvaluationSession::lookup_special_module(con
       return result;
     }
   }
+  if (parent) return parent->lookup_special_module(name, loc);
   LOG(message_group::Warning, loc, documentRoot(), "Ignoring unknown module '%1$s'", name);
   return boost::none;
 }
@@ -1,24 +1,31 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 #include <boost/optional.hpp>
 
 #include "core/ContextMemoryManager.h"
+#include "core/EvaluationArena.h"
+#include "core/FunctionResultCache.h"
+#include "core/ModuleInstanceCache.h"
 #include "core/AST.h"
 #include "core/function.h"
 #include "core/module.h"
 #include "core/Value.h"
 
 class ContextFrame;
+class MemoKey;
 
 class EvaluationSession
 {
 public:
-  EvaluationSession(std::string documentRoot) :
-    document_root(std::move(documentRoot))
+  // Special variables, functions and modules not found on the stack are looked up in
+  // the parent session, if any.
+  EvaluationSession(std::string documentRoot, const EvaluationSession *parent = nullptr) :
+    document_root(std::move(documentRoot)), parent(parent), context_memory_manager(evaluation_arena->accounting())
   {}
 
   size_t push_frame(ContextFrame *frame);
@@ -26,16 +33,51 @@ public:
   void pop_frame(size_t index);
 
   [[nodiscard]] boost::optional<const Value&> try_lookup_special_variable(const std::string& name) const;
+  // Looks up a special variable without recording the read (see FunctionResultCache)
+  [[nodiscard]] boost::optional<const Value&> find_special_variable(const std::string& name) const;
   [[nodiscard]] const Value& lookup_special_variable(const std::string& name, const Location& loc) const;
   [[nodiscard]] boost::optional<CallableFunction> lookup_special_function(const std::string& name, const Location& loc) const;
   [[nodiscard]] boost::optional<InstantiableModule> lookup_special_module(const std::string& name, const Location& loc) const;
 
+  // Adds the values of all special variables visible on the stack, except
+  // $parent_modules, whose reads are counted as impure operations instead.
+  void add_special_variables(MemoKey& key) const;
+
+  // Operations whose effects are lost when a memoized result is reused instead
+  // of evaluating again, e.g. advancing the random number generator or looking
+  // at the module call stack. Log messages are counted separately (print_message_count()).
+  // On worker threads of a parallel loop, this aborts the parallel evaluation
+  // since the count of the starting session wouldn't see the operation.
+  void record_impure_operation() const;
+  [[nodiscard]] size_t impure_operation_count() const { return impure_operations; }
+
   [[nodiscard]] const std::string& documentRoot() const { return document_root; }
   ContextMemoryManager& contextMemoryManager() { return context_memory_manager; }
-  HeapSizeAccounting& accounting() { return context_memory_manager.accounting(); }
+  EvaluationArena& arena() { return *evaluation_arena; }
+  HeapSizeAccounting& accounting() { return evaluation_arena->accounting(); }
+  ModuleInstanceCache& moduleInstanceCache() { return module_instance_cache; }
+  FunctionResultCache& functionResultCache() { return function_result_cache; }
+  [[nodiscard]] const ContextMemoryManager& contextMemoryManager() const { return context_memory_manager; }
+  [[nodiscard]] const ModuleInstanceCache& moduleInstanceCache() const { return module_instance_cache; }
+  [[nodiscard]] const FunctionResultCache& functionResultCache() const { return function_result_cache; }
+  // Session of the worker thread with the given index, see ParallelEvaluation
+  EvaluationSession& workerSession(size_t index);
 
 private:
   std::string document_root;
+  const EvaluationSession *parent;
   std::vector<ContextFrame *> stack;
+  // Destroyed last, as values created by workers may be held by this session's
+  // contexts and caches. Workers don't memoize, so they only refer back to values
+  // of this session while evaluating.
+  std::vector<std::unique_ptr<EvaluationSession>> worker_sessions;
+  // Declared before the context memory manager, which frees the remaining contexts when destroyed.
+  // Released rather than destroyed, see EvaluationArena.
+  EvaluationArena::Handle evaluation_arena{EvaluationArena::create()};
   ContextMemoryManager context_memory_manager;
+  ModuleInstanceCache module_instance_cache;
+  // Declared after the context memory manager, since cached values update its heap accounting
+  // when destroyed. Mutable since reads of special variables are recorded.
+  mutable FunctionResultCache function_result_cache;
+  mutable size_t impure_operations{0};
 };
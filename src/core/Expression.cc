@@ -43,6 +43,12 @@
 #include "utils/printutils.h"
 #include "utils/StackCheck.h"
 #include "core/Context.h"
+#include "core/EvaluationSession.h"
+#include "core/FunctionResultCache.h"
+#include "core/MemoKey.h"
+#include "core/ParallelEvaluation.h"
+#include "core/ScopeContext.h"
+#include "Feature.h"
 #include "utils/exceptions.h"
 #include "core/Parameters.h"
 #include "utils/printutils.h"
@@ -409,6 +415,8 @@ FunctionDefinition::FunctionDefinition(Expression *expr, AssignmentList paramete
 
 Value FunctionDefinition::evaluate(const std::shared_ptr<const Context>& context) const
 {
+  // Function literals keep their context, which must not belong to a worker's session
+  ParallelEvaluation::requireSequential();
   return FunctionPtr{FunctionType{context, expr, std::make_unique<AssignmentList>(parameters)}};
 }
 
@@ -484,6 +492,7 @@ struct SimplifiedExpression {
   const Expression *expression;
   boost::optional<ContextHandle<Context>> new_context = boost::none;
   boost::optional<const FunctionCall *> new_active_function_call = boost::none;
+  const UserFunction *user_function = nullptr; // Set when calling a named user function
 };
 using SimplificationResult = std::variant<SimplifiedExpression, Value>;
 
@@ -513,6 +522,7 @@ static SimplificationResult simplify_function_body(const Expression *expression,
       const Expression *function_body;
       const AssignmentList *required_parameters;
       std::shared_ptr<const Context> defining_context;
+      const UserFunction *user_function = nullptr;
 
       auto f = call->evaluate_function_expression(context);
       if (!f) {
@@ -520,9 +530,11 @@ static SimplificationResult simplify_function_body(const Expression *expression,
       } else {
         auto index = f->index();
         if (index == 0) {
+          if (!ParallelEvaluation::isThreadSafe(call->get_name())) ParallelEvaluation::requireSequential();
           return std::get<const BuiltinFunction *>(*f)->evaluate(context, call);
         } else if (index == 1) {
           CallableUserFunction callable = std::get<CallableUserFunction>(*f);
+          user_function = callable.function;
           function_body = callable.function->expr.get();
           required_parameters = &callable.function->parameters;
           defining_context = callable.defining_context;
@@ -546,13 +558,36 @@ static SimplificationResult simplify_function_body(const Expression *expression,
       Parameters parameters = Parameters::parse(std::move(arguments), call->location(), *required_parameters, defining_context);
       body_context->apply_variables(std::move(parameters).to_context_frame());
 
-      return SimplifiedExpression{function_body, std::move(body_context), call};
+      return SimplifiedExpression{function_body, std::move(body_context), call, user_function};
     } else {
       return expression->evaluate(context);
     }
   }
 }
 
+/*!
+   Builds the key under which the result of calling a user function is
+   memoized, or returns an invalid key if the call can't be memoized.
+
+   The body context holds the parameters, and lexical variables from outside
+   the function are only constant for functions defined at file level.
+   Special variables are handled by FunctionResultCache.
+ */
+static MemoKey make_result_key(const UserFunction *function, const Context& body_context)
+{
+  MemoKey key;
+  if (!std::dynamic_pointer_cast<const FileContext>(body_context.getParent())) {
+    key.invalidate();
+    return key;
+  }
+  key.add(function);
+  for (const auto& parameter : function->parameters) {
+    const auto value = body_context.lookup_local_variable(parameter->getName());
+    key.add(value ? *value : Value::undefined);
+  }
+  return key;
+}
+
 Value FunctionCall::evaluate(const std::shared_ptr<const Context>& context) const
 {
   const auto& name = get_name();
@@ -570,20 +605,45 @@ Value FunctionCall::evaluate(const std::shared_ptr<const Context>& context) cons
 
   ContextHandle<Context> expression_context{Context::create<Context>(context)};
   const Expression *expression = this;
+
+  // Only the result of this call is memoized, not those of the tail calls it
+  // turns into, so tail recursion doesn't fill the cache. A result is only
+  // stored if evaluating it had no observable side effects.
+  EvaluationSession *session = expression_context->session();
+  MemoKey memo_key;
+  boost::optional<FunctionResultCache::Recording> recording;
+  size_t impure_operations = 0;
+  size_t messages = 0;
+
   while (true) {
     try {
       auto result = simplify_function_body(expression, *expression_context);
       if (Value *value = std::get_if<Value>(&result)) {
+        if (recording && session->impure_operation_count() == impure_operations && print_message_count() == messages) {
+          recording->store(memo_key.str(), *value);
+        }
         return std::move(*value);
       }
 
       SimplifiedExpression *simplified_expression = std::get_if<SimplifiedExpression>(&result);
       assert(simplified_expression);
 
+      const bool first_call = expression == this;
       expression = simplified_expression->expression;
       if (simplified_expression->new_context) {
         expression_context = std::move(*simplified_expression->new_context);
       }
+      if (first_call && simplified_expression->user_function && Feature::ExperimentalFunctionMemoization.is_enabled() &&
+          !ParallelEvaluation::inWorker()) {
+        memo_key = make_result_key(simplified_expression->user_function, **expression_context);
+        if (memo_key.valid()) {
+          auto& cache = session->functionResultCache();
+          if (auto value = cache.find(memo_key.str(), *session)) return std::move(*value);
+          recording.emplace(cache);
+          impure_operations = session->impure_operation_count();
+          messages = print_message_count();
+        }
+      }
       if (simplified_expression->new_active_function_call) {
         current_call = *simplified_expression->new_active_function_call;
         if (recursion_depth++ == 1000000) {
@@ -832,14 +892,19 @@ static void doForEach(
   size_t assignment_index,
   const std::shared_ptr<const Context>& context,
   const std::function<void(size_t)> *pReserve = nullptr
-  ) {
-  if (assignment_index >= assignments.size()) {
-    operation(context);
-    return;
-  }
+  );
 
+// Iterates over the already evaluated values of assignments[assignment_index]
+static void doForEachValue(
+  const AssignmentList& assignments,
+  const Location& location,
+  const std::function<void(const std::shared_ptr<const Context>&)>& operation,
+  size_t assignment_index,
+  const std::shared_ptr<const Context>& context,
+  Value variable_values,
+  const std::function<void(size_t)> *pReserve = nullptr
+  ) {
   const std::string& variable_name = assignments[assignment_index]->getName();
-  Value variable_values = assignments[assignment_index]->getExpr()->evaluate(context);
 
   if (variable_values.type() == Value::Type::RANGE) {
     const RangeType& range = variable_values.toRange();
@@ -894,6 +959,22 @@ static void doForEach(
   }
 }
 
+static void doForEach(
+  const AssignmentList& assignments,
+  const Location& location,
+  const std::function<void(const std::shared_ptr<const Context>&)>& operation,
+  size_t assignment_index,
+  const std::shared_ptr<const Context>& context,
+  const std::function<void(size_t)> *pReserve
+  ) {
+  if (assignment_index >= assignments.size()) {
+    operation(context);
+    return;
+  }
+  doForEachValue(assignments, location, operation, assignment_index, context,
+                 assignments[assignment_index]->getExpr()->evaluate(context), pReserve);
+}
+
 void LcFor::forEach(const AssignmentList& assignments, const Location& loc, const std::shared_ptr<const Context>& context, const std::function<void(const std::shared_ptr<const Context>&)>& operation, const std::function<void(size_t)>* pReserve)
 {
   doForEach(assignments, loc, operation, 0, context, pReserve);
@@ -905,10 +986,25 @@ Value LcFor::evaluate(const std::shared_ptr<const Context>& context) const
   std::function<void(size_t)> reserve = [&vec](size_t capacity) {
     vec.reserve(capacity);
   };
-  forEach(this->arguments, this->loc, context,
-          [&vec, expression = expr.get()] (const std::shared_ptr<const Context>& iterationContext) {
+  auto operation = [&vec, expression = expr.get()] (const std::shared_ptr<const Context>& iterationContext) {
     vec.emplace_back(expression->evaluate(iterationContext));
-  }, &reserve);
+  };
+  if (this->arguments.empty()) {
+    forEach(this->arguments, this->loc, context, operation, &reserve);
+    return {std::move(vec)};
+  }
+
+  // Only the outermost loop variable is iterated in parallel
+  Value values = this->arguments[0]->getExpr()->evaluate(context);
+  auto iteration = [this](const std::shared_ptr<const Context>& iterationContext, EmbeddedVectorType& output) {
+    doForEach(this->arguments, this->loc,
+              [&output, expression = expr.get()] (const std::shared_ptr<const Context>& innerContext) {
+      output.emplace_back(expression->evaluate(innerContext));
+    }, 1, iterationContext);
+  };
+  if (!ParallelEvaluation::forEach(context, this->arguments[0]->getName(), values, iteration, vec, this->parallel_aborted)) {
+    doForEachValue(this->arguments, this->loc, operation, 0, context, std::move(values), &reserve);
+  }
   return {std::move(vec)};
 }
 
@@ -267,6 +267,9 @@ public:
 private:
   AssignmentList arguments;
   std::shared_ptr<Expression> expr;
+  // Set once parallel evaluation had to fall back to sequential evaluation. Only
+  // accessed on the main thread, see ParallelEvaluation::forEach().
+  mutable bool parallel_aborted = false;
 };
 
 class LcForC : public ListComprehension
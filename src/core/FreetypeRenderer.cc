@@ -31,6 +31,7 @@
 #include <memory>
 #include <cmath>
 #include <cstdio>
+#include <string>
 #include <vector>
 
 
@@ -41,6 +42,8 @@
 
 #include "FontCache.h"
 #include "core/DrawingCallback.h"
+#include "core/GlyphCache.h"
+#include "geometry/Polygon2d.h"
 #include "utils/calc.h"
 
 #include FT_OUTLINE_H
@@ -322,71 +325,21 @@ void FreetypeRenderer::Params::set(Parameters& parameters)
 FreetypeRenderer::ShapeResults::ShapeResults(
   const FreetypeRenderer::Params& params)
 {
-  FT_Face face = params.get_font_face();
+  face = params.get_font_face();
   if (face == nullptr) {
     return;
   }
-
-  hb_ft_font = hb_ft_font_create(face, nullptr);
-
-  hb_buf = hb_buffer_create();
-  hb_buffer_set_direction(hb_buf, hb_direction_from_string(params.direction.c_str(), -1));
-  hb_buffer_set_script(hb_buf, hb_script_from_string(params.script.c_str(), -1));
-  hb_buffer_set_language(hb_buf, hb_language_from_string(params.language.c_str(), -1));
-  if (FontCache::instance()->is_windows_symbol_font(face)) {
-    // Special handling for symbol fonts like Webdings.
-    // see http://www.microsoft.com/typography/otspec/recom.htm
-    //
-    // We go through the string char by char and if the codepoint
-    // value is between 0x00 and 0xff, then the codepoint is translated
-    // to the 0xf000 page (Private Use Area of Unicode). All other
-    // values are untouched, so using the correct codepoint directly
-    // (e.g. \uf021 for the spider in Webdings) still works.
-    str_utf8_wrapper utf8_str{params.text};
-    if (utf8_str.utf8_validate()) {
-      for (auto ch : utf8_str) {
-        gunichar c = ch.get_utf8_char();
-        c = (c < 0x0100) ? 0xf000 + c : c;
-        hb_buffer_add_utf32(hb_buf, &c, 1, 0, 1);
-      }
-    } else {
-      LOG(message_group::Warning, params.loc, params.documentPath,
-          "Ignoring text with invalid UTF-8 encoding: \"%1$s\"",
-          params.text.c_str());
-    }
-  } else {
-    hb_buffer_add_utf8(hb_buf, params.text.c_str(), strlen(params.text.c_str()), 0, strlen(params.text.c_str()));
-  }
-  hb_shape(hb_ft_font, hb_buf, nullptr, 0);
-
-  unsigned int glyph_count;
-  hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(hb_buf, &glyph_count);
-  hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(hb_buf, &glyph_count);
-
-  glyph_array.reserve(glyph_count);
-  for (unsigned int idx = 0; idx < glyph_count; ++idx) {
-    FT_Error error;
-    FT_UInt glyph_index = glyph_info[idx].codepoint;
-    error = FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT);
-    if (error) {
-      LOG(message_group::Warning, params.loc, params.documentPath,
-          "Could not load glyph %1$u"
-          " for char at index %2$u in text '%3$s'",
-          glyph_index, idx, params.text);
-      continue;
-    }
-
-    FT_Glyph glyph;
-    error = FT_Get_Glyph(face->glyph, &glyph);
-    if (error) {
-      LOG(message_group::Warning, params.loc, params.documentPath,
-          "Could not get glyph %1$u"
-          " for char at index %2$u in text '%3$s'",
-          glyph_index, idx, params.text);
-      continue;
-    }
-
-    glyph_array.emplace_back(glyph, idx, &glyph_pos[idx]);
+  face_id = FontCache::instance()->get_face_id(face);
+
+  // Labels and serial numbers tend to repeat the same strings, so reuse their shaping
+  auto *cache = GlyphCache::instance();
+  const auto key = GlyphCache::shapeKey(face_id, params.text, params.direction, params.script, params.language);
+  shape = cache->getShape(key);
+  if (!shape) {
+    bool complete = true;
+    shape = shape_text(params, complete);
+    // Keep reporting problems with the text, rather than only on the first use
+    if (complete) cache->insertShape(key, shape);
   }
 
   ascent = std::numeric_limits<double>::lowest();
@@ -398,9 +351,8 @@ FreetypeRenderer::ShapeResults::ShapeResults(
   bottom = std::numeric_limits<double>::max();
   top = std::numeric_limits<double>::lowest();
 
-  for (const auto& glyph : glyph_array) {
-    FT_BBox bbox;
-    FT_Glyph_Get_CBox(glyph.get_glyph(), FT_GLYPH_BBOX_GRIDFIT, &bbox);
+  for (const auto& glyph : shape->glyphs) {
+    const FT_BBox& bbox = glyph.cbox;
 
     // Note that glyphs can extend left of their origin
     // and right of their advance-width, into the next
@@ -415,8 +367,8 @@ FreetypeRenderer::ShapeResults::ShapeResults(
       ascent = std::max(ascent, bbox.yMax / scale);
       descent = std::min(descent, bbox.yMin / scale);
 
-      const double gxoff = glyph.get_x_offset();
-      const double gyoff = glyph.get_y_offset();
+      const double gxoff = glyph.x_offset;
+      const double gyoff = glyph.y_offset;
 
       left = std::min(left,
                       advance_x + gxoff + bbox.xMin / scale);
@@ -429,16 +381,15 @@ FreetypeRenderer::ShapeResults::ShapeResults(
                         advance_y + gyoff + bbox.yMin / scale);
     }
 
-    advance_x += glyph.get_x_advance() * params.spacing;
-    advance_y += glyph.get_y_advance() * params.spacing;
+    advance_x += glyph.x_advance * params.spacing;
+    advance_y += glyph.y_advance * params.spacing;
   }
 
   // Right and left start out reversed.  If any ink is ever
   // contributed they will flip.  If they're still reversed,
   // there was no ink.
   if (right >= left) {
-    if (HB_DIRECTION_IS_HORIZONTAL(
-          hb_buffer_get_direction(hb_buf))) {
+    if (shape->horizontal) {
       calc_offsets_horiz(params);
     } else {
       calc_offsets_vert(params);
@@ -457,16 +408,89 @@ FreetypeRenderer::ShapeResults::ShapeResults(
   ok = true;
 }
 
-FreetypeRenderer::ShapeResults::~ShapeResults()
+// Shapes the text with HarfBuzz. complete is set to false if any
+// warnings were reported, so the result isn't cached.
+std::shared_ptr<const GlyphCache::ShapedText> FreetypeRenderer::ShapeResults::shape_text(
+  const FreetypeRenderer::Params& params, bool& complete) const
 {
-  if (hb_buf != nullptr) {
-    hb_buffer_destroy(hb_buf);
-    hb_buf = nullptr;
+  hb_font_t *hb_ft_font = hb_ft_font_create(face, nullptr);
+
+  hb_buffer_t *hb_buf = hb_buffer_create();
+  hb_buffer_set_direction(hb_buf, hb_direction_from_string(params.direction.c_str(), -1));
+  hb_buffer_set_script(hb_buf, hb_script_from_string(params.script.c_str(), -1));
+  hb_buffer_set_language(hb_buf, hb_language_from_string(params.language.c_str(), -1));
+  if (FontCache::instance()->is_windows_symbol_font(face)) {
+    // Special handling for symbol fonts like Webdings.
+    // see http://www.microsoft.com/typography/otspec/recom.htm
+    //
+    // We go through the string char by char and if the codepoint
+    // value is between 0x00 and 0xff, then the codepoint is translated
+    // to the 0xf000 page (Private Use Area of Unicode). All other
+    // values are untouched, so using the correct codepoint directly
+    // (e.g. \uf021 for the spider in Webdings) still works.
+    str_utf8_wrapper utf8_str{params.text};
+    if (utf8_str.utf8_validate()) {
+      for (auto ch : utf8_str) {
+        gunichar c = ch.get_utf8_char();
+        c = (c < 0x0100) ? 0xf000 + c : c;
+        hb_buffer_add_utf32(hb_buf, &c, 1, 0, 1);
+      }
+    } else {
+      LOG(message_group::Warning, params.loc, params.documentPath,
+          "Ignoring text with invalid UTF-8 encoding: \"%1$s\"",
+          params.text.c_str());
+      complete = false;
+    }
+  } else {
+    hb_buffer_add_utf8(hb_buf, params.text.c_str(), strlen(params.text.c_str()), 0, strlen(params.text.c_str()));
   }
-  if (hb_ft_font != nullptr) {
-    hb_font_destroy(hb_ft_font);
-    hb_ft_font = nullptr;
+  hb_shape(hb_ft_font, hb_buf, nullptr, 0);
+
+  unsigned int glyph_count;
+  hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(hb_buf, &glyph_count);
+  hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(hb_buf, &glyph_count);
+
+  auto result = std::make_shared<GlyphCache::ShapedText>();
+  result->horizontal = HB_DIRECTION_IS_HORIZONTAL(hb_buffer_get_direction(hb_buf));
+  result->glyphs.reserve(glyph_count);
+  for (unsigned int idx = 0; idx < glyph_count; ++idx) {
+    FT_Error error;
+    FT_UInt glyph_index = glyph_info[idx].codepoint;
+    error = FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT);
+    if (error) {
+      LOG(message_group::Warning, params.loc, params.documentPath,
+          "Could not load glyph %1$u"
+          " for char at index %2$u in text '%3$s'",
+          glyph_index, idx, params.text);
+      complete = false;
+      continue;
+    }
+
+    FT_Glyph glyph;
+    error = FT_Get_Glyph(face->glyph, &glyph);
+    if (error) {
+      LOG(message_group::Warning, params.loc, params.documentPath,
+          "Could not get glyph %1$u"
+          " for char at index %2$u in text '%3$s'",
+          glyph_index, idx, params.text);
+      complete = false;
+      continue;
+    }
+
+    GlyphCache::ShapedGlyph shaped;
+    shaped.index = glyph_index;
+    shaped.x_offset = glyph_pos[idx].x_offset / scale;
+    shaped.y_offset = glyph_pos[idx].y_offset / scale;
+    shaped.x_advance = glyph_pos[idx].x_advance / scale;
+    shaped.y_advance = glyph_pos[idx].y_advance / scale;
+    FT_Glyph_Get_CBox(glyph, FT_GLYPH_BBOX_GRIDFIT, &shaped.cbox);
+    FT_Done_Glyph(glyph);
+    result->glyphs.push_back(shaped);
   }
+
+  hb_buffer_destroy(hb_buf);
+  hb_font_destroy(hb_ft_font);
+  return result;
 }
 
 FreetypeRenderer::FontMetrics::FontMetrics(
@@ -547,6 +571,37 @@ FreetypeRenderer::TextMetrics::TextMetrics(
   ok = true;
 }
 
+// Returns the outlines of a glyph, flattened at unit size. Identical glyphs
+// (e.g. the digits of serial numbers) are only decomposed once.
+std::shared_ptr<const Polygon2d> FreetypeRenderer::get_glyph_outline(const ShapeResults& sr, unsigned int glyph_index, unsigned int segments) const
+{
+  auto *cache = GlyphCache::instance();
+  const auto key = GlyphCache::outlineKey(sr.face_id, glyph_index, segments);
+  if (auto outline = cache->getOutline(key)) {
+    return outline;
+  }
+
+  if (FT_Load_Glyph(sr.face, glyph_index, FT_LOAD_DEFAULT)) {
+    return nullptr;
+  }
+  FT_Glyph glyph;
+  if (FT_Get_Glyph(sr.face->glyph, &glyph)) {
+    return nullptr;
+  }
+
+  DrawingCallback callback(segments, 1.0);
+  callback.start_glyph();
+  FT_Outline outline = reinterpret_cast<FT_OutlineGlyph>(glyph)->outline;
+  FT_Outline_Decompose(&outline, &funcs, &callback);
+  callback.finish_glyph();
+  FT_Done_Glyph(glyph);
+
+  const auto polygons = callback.get_result();
+  std::shared_ptr<const Polygon2d> result = polygons.empty() ? std::make_shared<Polygon2d>() : polygons.front();
+  cache->insertOutline(key, result);
+  return result;
+}
+
 std::vector<std::shared_ptr<const Polygon2d>> FreetypeRenderer::render(const FreetypeRenderer::Params& params) const
 {
   ShapeResults sr(params);
@@ -556,16 +611,17 @@ std::vector<std::shared_ptr<const Polygon2d>> FreetypeRenderer::render(const Fre
   }
 
   DrawingCallback callback(params.segments, params.size);
-  for (const auto& glyph : sr.glyph_array) {
+  for (const auto& glyph : sr.shape->glyphs) {
     callback.start_glyph();
     callback.set_glyph_offset(
-      sr.x_offset + glyph.get_x_offset(),
-      sr.y_offset + glyph.get_y_offset());
-    FT_Outline outline = reinterpret_cast<FT_OutlineGlyph>(glyph.get_glyph())->outline;
-    FT_Outline_Decompose(&outline, &funcs, &callback);
+      sr.x_offset + glyph.x_offset,
+      sr.y_offset + glyph.y_offset);
+    if (auto outline = get_glyph_outline(sr, glyph.index, params.segments)) {
+      callback.add_outlines(*outline);
+    }
 
-    double adv_x = glyph.get_x_advance() * params.spacing;
-    double adv_y = glyph.get_y_advance() * params.spacing;
+    double adv_x = glyph.x_advance * params.spacing;
+    double adv_y = glyph.y_advance * params.spacing;
     callback.add_glyph_advance(adv_x, adv_y);
     callback.finish_glyph();
   }
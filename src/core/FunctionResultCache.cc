@@ -0,0 +1,153 @@
+#include "core/FunctionResultCache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/EvaluationSession.h"
+#include "core/MemoKey.h"
+
+namespace {
+
+// Returns false if the value can't be encoded
+bool encode(const boost::optional<const Value&>& value, std::string& out)
+{
+  if (!value) {
+    out.clear();
+    return true;
+  }
+  MemoKey key;
+  key.add(*value);
+  out = key.str();
+  return key.valid();
+}
+
+/*!
+   Function literals keep their defining context alive, which must not outlive
+   the context memory manager's view of it. Objects are left out as well.
+ */
+bool containsClosures(const Value& value)
+{
+  switch (value.type()) {
+  case Value::Type::FUNCTION:
+  case Value::Type::OBJECT:
+    return true;
+  case Value::Type::VECTOR:
+    for (const auto& element : value.toVector()) {
+      if (containsClosures(element)) return true;
+    }
+    return false;
+  default:
+    return false;
+  }
+}
+
+// Vector elements are shared with the evaluation, so this only approximates the memory held
+size_t estimateSize(const Value& value)
+{
+  switch (value.type()) {
+  case Value::Type::VECTOR:
+    return sizeof(Value) + value.toVector().size() * sizeof(Value);
+  case Value::Type::STRING:
+    return sizeof(Value) + value.toStrUtf8Wrapper().size();
+  default:
+    return sizeof(Value);
+  }
+}
+
+} // namespace
+
+FunctionResultCache::Recording::Recording(FunctionResultCache& cache) : cache(cache), start(cache.reads.size())
+{
+  cache.recordings.push_back(start);
+}
+
+FunctionResultCache::Recording::~Recording()
+{
+  cache.endRecording(start);
+}
+
+void FunctionResultCache::Recording::store(const std::string& key, const Value& result)
+{
+  if (containsClosures(result)) return;
+  std::vector<Read> reads(cache.reads.begin() + start, cache.reads.end());
+  size_t cost = sizeof(Result) + estimateSize(result);
+  for (const auto& read : reads) {
+    if (!read.valid) return;
+    cost += sizeof(Read) + read.name.size() + read.value.size();
+  }
+
+  auto *stored = cache.results.object(key);
+  if (!stored) {
+    stored = new std::vector<Result>();
+    stored->push_back({std::move(reads), result.clone(), cost});
+    cache.results.insert(key, stored, key.size() + cost);
+    return;
+  }
+  if (stored->size() == MAX_RESULTS_PER_KEY) stored->erase(stored->begin());
+  stored->push_back({std::move(reads), result.clone(), cost});
+  size_t total = key.size();
+  for (const auto& r : *stored) total += r.cost;
+  cache.results.setCost(key, total);
+}
+
+void FunctionResultCache::endRecording(size_t start)
+{
+  assert(!this->recordings.empty() && this->recordings.back() == start);
+  this->recordings.pop_back();
+  if (this->recordings.empty()) {
+    this->reads.clear();
+    return;
+  }
+  // Pass the reads on to the enclosing recording, dropping those it has already
+  const auto outer = this->reads.begin() + this->recordings.back();
+  const auto inner = this->reads.begin() + start;
+  size_t end = start;
+  for (size_t i = start; i < this->reads.size(); ++i) {
+    if (std::find(outer, inner, this->reads[i]) != inner) continue;
+    if (end != i) this->reads[end] = std::move(this->reads[i]);
+    ++end;
+  }
+  this->reads.resize(end);
+}
+
+void FunctionResultCache::addRead(Read&& read)
+{
+  const auto begin = this->reads.begin() + this->recordings.back();
+  if (std::find(begin, this->reads.end(), read) == this->reads.end()) {
+    this->reads.push_back(std::move(read));
+  }
+}
+
+void FunctionResultCache::recordRead(const std::string& name, const boost::optional<const Value&>& value)
+{
+  if (this->recordings.empty()) return;
+  Read read{name, {}, true};
+  read.valid = encode(value, read.value);
+  addRead(std::move(read));
+}
+
+boost::optional<Value> FunctionResultCache::find(const std::string& key, const EvaluationSession& session)
+{
+  const auto *stored = this->results.object(key);
+  if (stored) {
+    std::string current;
+    for (auto result = stored->rbegin(); result != stored->rend(); ++result) {
+      const bool match = std::all_of(result->reads.begin(), result->reads.end(), [&](const Read& read) {
+        return encode(session.find_special_variable(read.name), current) && current == read.value;
+      });
+      if (!match) continue;
+      // The reads are dependencies of any enclosing evaluation as well
+      if (!this->recordings.empty()) {
+        for (const auto& read : result->reads) addRead(Read(read));
+      }
+      ++this->hits;
+      return result->value.clone();
+    }
+  }
+  ++this->misses;
+  return boost::none;
+}
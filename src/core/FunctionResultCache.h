@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "Cache.h"
+#include "core/Value.h"
+
+class EvaluationSession;
+
+/*!
+   Results of user function calls, by MemoKey of the function and its
+   arguments. See FunctionCall::evaluate() for which calls are memoized.
+
+   Results can also depend on special variables. Rather than keying on all of
+   them, the special variables read during an evaluation are recorded along
+   with its result, and the result is only reused while each of them still
+   has the value which was read. Reads of special variables set within the
+   evaluation are recorded as well, which can only cause misses.
+
+   The cache is bounded by an estimate of its size in bytes, and lives as long
+   as the EvaluationSession.
+ */
+class FunctionResultCache
+{
+public:
+  /*!
+     Records the special variables read while it is alive. Nested recordings
+     pass their reads on to the enclosing one when they end.
+   */
+  class Recording
+  {
+public:
+    Recording(FunctionResultCache& cache);
+    ~Recording();
+    Recording(const Recording&) = delete;
+    Recording& operator=(const Recording&) = delete;
+
+    // Stores the result under the given key, along with the reads recorded so far
+    void store(const std::string& key, const Value& result);
+
+private:
+    FunctionResultCache& cache;
+    size_t start;
+  };
+
+  FunctionResultCache(size_t maxBytes = 64ul * 1024ul * 1024ul) : results(maxBytes) {}
+
+  // Returns the result if one was stored whose reads match the current special variables
+  boost::optional<Value> find(const std::string& key, const EvaluationSession& session);
+  void recordRead(const std::string& name, const boost::optional<const Value&>& value);
+  [[nodiscard]] bool isRecording() const { return !this->recordings.empty(); }
+
+  [[nodiscard]] size_t size() const { return this->results.size(); }
+  [[nodiscard]] size_t totalCost() const { return this->results.totalCost(); }
+  [[nodiscard]] size_t hitCount() const { return this->hits; }
+  [[nodiscard]] size_t missCount() const { return this->misses; }
+
+  // Only the most recently stored results are kept for each key
+  constexpr static size_t MAX_RESULTS_PER_KEY = 8;
+
+private:
+  struct Read {
+    std::string name;
+    std::string value; // MemoKey of the value, empty if the variable is undefined
+    bool valid;        // false if the value can't be encoded (function literals)
+    bool operator==(const Read& other) const {
+      return this->valid == other.valid && this->name == other.name && this->value == other.value;
+    }
+  };
+  struct Result {
+    std::vector<Read> reads;
+    Value value;
+    size_t cost;
+  };
+
+  void addRead(Read&& read);
+  void endRecording(size_t start);
+
+  Cache<std::string, std::vector<Result>> results;
+  std::vector<Read> reads; // Reads of all running recordings, innermost last
+  std::vector<size_t> recordings; // Start of each running recording in reads
+  size_t hits{0};
+  size_t misses{0};
+};
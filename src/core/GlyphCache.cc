@@ -0,0 +1,61 @@
+#include "core/GlyphCache.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "geometry/Polygon2d.h"
+
+GlyphCache *GlyphCache::inst = nullptr;
+
+std::string GlyphCache::shapeKey(const std::string& face, const std::string& text, const std::string& direction,
+                                 const std::string& script, const std::string& language)
+{
+  std::string key;
+  key.reserve(face.size() + text.size() + direction.size() + script.size() + language.size() + 4);
+  for (const auto *part : {&face, &direction, &script, &language}) {
+    key += *part;
+    key += '\0';
+  }
+  key += text;
+  return key;
+}
+
+std::string GlyphCache::outlineKey(const std::string& face, unsigned int glyph, unsigned int segments)
+{
+  std::string key = face;
+  key += '\0';
+  key += std::to_string(glyph);
+  key += '\0';
+  key += std::to_string(segments);
+  return key;
+}
+
+std::shared_ptr<const GlyphCache::ShapedText> GlyphCache::getShape(const std::string& key) const
+{
+  const auto *shape = this->shapes[key];
+  return shape ? *shape : nullptr;
+}
+
+void GlyphCache::insertShape(const std::string& key, const std::shared_ptr<const ShapedText>& shape)
+{
+  const size_t cost = key.size() + sizeof(ShapedText) + shape->glyphs.size() * sizeof(ShapedGlyph);
+  this->shapes.insert(key, new std::shared_ptr<const ShapedText>(shape), cost);
+}
+
+std::shared_ptr<const Polygon2d> GlyphCache::getOutline(const std::string& key) const
+{
+  const auto *outline = this->outlines[key];
+  return outline ? *outline : nullptr;
+}
+
+void GlyphCache::insertOutline(const std::string& key, const std::shared_ptr<const Polygon2d>& outline)
+{
+  this->outlines.insert(key, new std::shared_ptr<const Polygon2d>(outline), key.size() + outline->memsize());
+}
+
+void GlyphCache::clear()
+{
+  this->shapes.clear();
+  this->outlines.clear();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Cache.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+class Polygon2d;
+
+/*!
+   Per-process cache of shaped text and flattened glyph outlines, used by
+   text(), textmetrics() and fontmetrics().
+
+   Text is shaped once per font face, direction, script, language and string.
+   Each glyph is decomposed and flattened once per font face, glyph index and
+   number of curve segments. Fonts are always loaded at the same nominal
+   character size and text() only scales the result, so glyphs are cached at
+   unit size and the size doesn't take part in the keys.
+ */
+class GlyphCache
+{
+public:
+  // Position of a glyph in the shaped text, in fractions of the font size
+  struct ShapedGlyph {
+    unsigned int index; // Glyph index in the font face
+    double x_offset;
+    double y_offset;
+    double x_advance;
+    double y_advance;
+    FT_BBox cbox; // Grid-fitted control box, in font units
+  };
+
+  struct ShapedText {
+    std::vector<ShapedGlyph> glyphs;
+    bool horizontal{true};
+  };
+
+  GlyphCache(size_t memorylimit = 16ul * 1024ul * 1024ul) : shapes(memorylimit / 2), outlines(memorylimit / 2) {}
+
+  static GlyphCache *instance() { if (!inst) inst = new GlyphCache; return inst; }
+
+  static std::string shapeKey(const std::string& face, const std::string& text, const std::string& direction,
+                              const std::string& script, const std::string& language);
+  static std::string outlineKey(const std::string& face, unsigned int glyph, unsigned int segments);
+
+  [[nodiscard]] std::shared_ptr<const ShapedText> getShape(const std::string& key) const;
+  void insertShape(const std::string& key, const std::shared_ptr<const ShapedText>& shape);
+  // Glyphs without outlines (e.g. spaces) are cached as empty polygons
+  [[nodiscard]] std::shared_ptr<const Polygon2d> getOutline(const std::string& key) const;
+  void insertOutline(const std::string& key, const std::shared_ptr<const Polygon2d>& outline);
+  void clear();
+
+private:
+  static GlyphCache *inst;
+
+  Cache<std::string, std::shared_ptr<const ShapedText>> shapes;
+  Cache<std::string, std::shared_ptr<const Polygon2d>> outlines;
+};
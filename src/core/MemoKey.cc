@@ -0,0 +1,78 @@
+#include "core/MemoKey.h"
+
+#include <cstddef>
+#include <string>
+
+#include "core/Value.h"
+#include "utils/StackCheck.h"
+
+void MemoKey::addBytes(const void *data, size_t size)
+{
+  this->key.append(static_cast<const char *>(data), size);
+}
+
+void MemoKey::add(const void *ptr)
+{
+  addBytes(&ptr, sizeof(ptr));
+}
+
+void MemoKey::add(const std::string& name)
+{
+  const size_t size = name.size();
+  addBytes(&size, sizeof(size));
+  this->key += name;
+}
+
+void MemoKey::invalidate()
+{
+  this->is_valid = false;
+  this->key.clear();
+}
+
+void MemoKey::add(const Value& value)
+{
+  if (!this->is_valid) return;
+  const auto type = value.type();
+  this->key += static_cast<char>(type);
+  switch (type) {
+  case Value::Type::UNDEFINED:
+    break;
+  case Value::Type::BOOL:
+    this->key += value.toBool() ? '1' : '0';
+    break;
+  case Value::Type::NUMBER: {
+    const double d = value.toDouble();
+    addBytes(&d, sizeof(d));
+    break;
+  }
+  case Value::Type::STRING:
+    add(value.toStrUtf8Wrapper().toString());
+    break;
+  case Value::Type::VECTOR:
+  case Value::Type::EMBEDDED_VECTOR: {
+    const VectorType& vec = type == Value::Type::VECTOR ? value.toVector() : value.toEmbeddedVector();
+    // Deeply nested vectors are not worth memoizing and could exhaust the stack.
+    if (StackCheck::inst().check()) {
+      invalidate();
+      return;
+    }
+    const size_t size = vec.size();
+    addBytes(&size, sizeof(size));
+    for (const auto& element : vec) {
+      add(element);
+      if (!this->is_valid) return;
+    }
+    break;
+  }
+  case Value::Type::RANGE: {
+    const auto& range = value.toRange();
+    const double values[] = {range.begin_value(), range.step_value(), range.end_value()};
+    addBytes(values, sizeof(values));
+    break;
+  }
+  case Value::Type::FUNCTION:
+  case Value::Type::OBJECT:
+    invalidate();
+    break;
+  }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class Value;
+
+/*!
+   Builds a byte string identifying the inputs of an evaluation, so that its
+   result can be reused when the same inputs come up again.
+
+   Values are encoded by content. Function literals capture their defining
+   context and objects have no content based comparison, so adding either of
+   them invalidates the key.
+ */
+class MemoKey
+{
+public:
+  void add(const void *ptr);
+  void add(const std::string& name);
+  void add(const Value& value);
+  void invalidate();
+
+  [[nodiscard]] bool valid() const { return this->is_valid; }
+  [[nodiscard]] const std::string& str() const { return this->key; }
+
+private:
+  void addBytes(const void *data, size_t size);
+
+  std::string key;
+  bool is_valid{true};
+};
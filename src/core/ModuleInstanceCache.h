@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+class AbstractNode;
+
+/*!
+   Node subtrees instantiated from user modules, by MemoKey of the module call.
+   See UserModule::instantiate() for which calls are memoized.
+
+   Cached subtrees are shared between all calls with the same key, so the node
+   tree becomes a DAG. Nodes must not be modified once they're instantiated.
+   The cache lives as long as the EvaluationSession, and holds no nodes which
+   aren't part of the resulting tree anyway.
+ */
+class ModuleInstanceCache
+{
+public:
+  std::shared_ptr<AbstractNode> find(const std::string& key) {
+    auto it = this->instances.find(key);
+    if (it == this->instances.end()) {
+      ++this->misses;
+      return nullptr;
+    }
+    ++this->hits;
+    return it->second;
+  }
+
+  void insert(const std::string& key, const std::shared_ptr<AbstractNode>& node) {
+    this->instances.emplace(key, node);
+  }
+
+  [[nodiscard]] size_t size() const { return this->instances.size(); }
+  [[nodiscard]] size_t hitCount() const { return this->hits; }
+  [[nodiscard]] size_t missCount() const { return this->misses; }
+
+private:
+  std::unordered_map<std::string, std::shared_ptr<AbstractNode>> instances;
+  size_t hits{0};
+  size_t misses{0};
+};
@@ -33,6 +33,21 @@ public:
     return rootString.substr(indexpair.first, indexpair.second - indexpair.first);
   }
 
+  // Nodes shared by several parents are visited more than once while dumping
+  bool isStarted(const size_t nodeidx) const {
+    return this->cache.count(nodeidx) > 0;
+  }
+
+  bool isComplete(const size_t nodeidx) const {
+    auto result = this->cache.find(nodeidx);
+    return result != this->cache.end() && result->second.second >= 0L;
+  }
+
+  std::pair<long, long> range(const size_t nodeidx) const {
+    // throws std::out_of_range on miss
+    return this->cache.at(nodeidx);
+  }
+
   void insertStart(const size_t nodeidx, const long startindex) {
     assert(this->cache.count(nodeidx) == 0 && "start index inserted twice");
     this->cache.emplace(nodeidx, std::make_pair(startindex, -1L));
@@ -2,11 +2,9 @@
 #include "core/State.h"
 #include "core/ModuleInstantiation.h"
 #include <algorithm>
-#include <iterator>
 #include <ostream>
 #include <string>
 #include <sstream>
-#include <boost/regex.hpp>
 
 
 void GroupNodeChecker::incChildCount(int groupNodeIndex) {
@@ -29,8 +27,9 @@ int GroupNodeChecker::getChildCount(int groupNodeIndex) const {
 Response GroupNodeChecker::visit(State& state, const GroupNode& node)
 {
   if (state.isPrefix()) {
-    // create entry for group node, which children may increment
-    this->groupChildCounts.emplace(node.index(), 0);
+    // create entry for group node, which children may increment.
+    // Shared groups (see ModuleInstanceCache) are only counted once.
+    if (!this->groupChildCounts.emplace(node.index(), 0).second) return Response::PruneTraversal;
   } else if (state.isPostfix()) {
     if ((this->getChildCount(node.index()) > 0) && state.parent()) {
       this->incChildCount(state.parent()->index());
@@ -73,6 +72,46 @@ bool NodeDumper::isCached(const AbstractNode& node) const
   return this->cache.contains(node);
 }
 
+/*!
+   Nodes shared by several parents (see ModuleInstanceCache) produce the same
+   id string wherever they occur, so later occurrences copy the text of the
+   first one instead of traversing the subtree again. Modifiers passed down by
+   list nodes are part of the text, so it is only copied if there are none.
+   Returns true if the dump was copied, in which case traversal must be pruned.
+ */
+bool NodeDumper::copyDump(const State& state, const AbstractNode& node)
+{
+  const bool inherited = state.isBackground() || state.isHighlight();
+  if (!this->cache.isStarted(node.index())) {
+    if (inherited) this->inheritedModifiers.insert(node.index());
+    return false;
+  }
+  if (!this->idString || inherited || this->inheritedModifiers.count(node.index())) return false;
+
+  const auto [start, end] = this->cache.range(node.index());
+  std::string text(end - start, '\0');
+  this->dumpstream.seekg(start);
+  this->dumpstream.read(&text[0], static_cast<std::streamsize>(text.size()));
+  this->dumpstream << text;
+  this->copied = &node;
+  return true;
+}
+
+// Later occurrences of shared nodes which aren't copied keep the cache entry of the first one
+void NodeDumper::insertStart(const AbstractNode& node)
+{
+  if (!this->cache.isStarted(node.index())) {
+    this->cache.insertStart(node.index(), this->dumpstream.tellp());
+  }
+}
+
+void NodeDumper::insertEnd(const AbstractNode& node)
+{
+  if (!this->cache.isComplete(node.index())) {
+    this->cache.insertEnd(node.index(), this->dumpstream.tellp());
+  }
+}
+
 Response NodeDumper::visit(State& state, const GroupNode& node)
 {
   if (!this->idString) {
@@ -96,20 +135,25 @@ Response NodeDumper::visit(State& state, const GroupNode& node)
     this->dumpstream << "/*" << node.index() << "*/";
 #endif
 
+    if (copyDump(state, node)) return Response::PruneTraversal;
     // insert start index
-    this->cache.insertStart(node.index(), this->dumpstream.tellp());
+    insertStart(node);
 
     if (this->groupChecker.getChildCount(node.index()) > 1) {
       this->dumpstream << node << "{";
     }
     this->currindent++;
   } else if (state.isPostfix()) {
+    if (this->copied == &node) {
+      this->copied = nullptr;
+      return Response::ContinueTraversal;
+    }
     this->currindent--;
     if (this->groupChecker.getChildCount(node.index()) > 1) {
       this->dumpstream << "}";
     }
     // insert end index
-    this->cache.insertEnd(node.index(), this->dumpstream.tellp());
+    insertEnd(node);
 
     // For handling root modifier '!'
     // Check if we are processing the root of the current Tree and finalize cache
@@ -146,15 +190,13 @@ Response NodeDumper::visit(State& state, const AbstractNode& node)
     this->dumpstream << "/*" << node.index() << "*/";
 #endif
 
+    if (copyDump(state, node)) return Response::PruneTraversal;
     // insert start index
-    this->cache.insertStart(node.index(), this->dumpstream.tellp());
+    insertStart(node);
 
     if (this->idString) {
 
-      static const boost::regex re(R"([^\s\"]+|\"(?:[^\"\\]|\\.)*\")");
-      const auto name = STR(node);
-      boost::sregex_token_iterator it(name.begin(), name.end(), re, 0);
-      std::copy(it, boost::sregex_token_iterator(), std::ostream_iterator<std::string>(this->dumpstream));
+      this->dumpstream << node.idString();
 
       if (node.getChildren().size() > 0) {
         this->dumpstream << "{";
@@ -174,6 +216,10 @@ Response NodeDumper::visit(State& state, const AbstractNode& node)
     this->currindent++;
 
   } else if (state.isPostfix()) {
+    if (this->copied == &node) {
+      this->copied = nullptr;
+      return Response::ContinueTraversal;
+    }
 
     this->currindent--;
 
@@ -195,7 +241,7 @@ Response NodeDumper::visit(State& state, const AbstractNode& node)
     }
 
     // insert end index
-    this->cache.insertEnd(node.index(), this->dumpstream.tellp());
+    insertEnd(node);
 
     // For handling root modifier '!'
     // Check if we are processing the root of the current Tree and finalize cache
@@ -217,12 +263,17 @@ Response NodeDumper::visit(State& state, const ListNode& node)
     if (this->root.get() == &node) {
       this->initCache();
     }
+    if (copyDump(state, node)) return Response::PruneTraversal;
     // pass modifiers down to children via state
     if (node.modinst->isHighlight()) state.setHighlight(true);
     if (node.modinst->isBackground()) state.setBackground(true);
-    this->cache.insertStart(node.index(), this->dumpstream.tellp());
+    insertStart(node);
   } else if (state.isPostfix()) {
-    this->cache.insertEnd(node.index(), this->dumpstream.tellp());
+    if (this->copied == &node) {
+      this->copied = nullptr;
+      return Response::ContinueTraversal;
+    }
+    insertEnd(node);
     // For handling root modifier '!'
     if (this->root.get() == &node) {
       this->finalizeCache();
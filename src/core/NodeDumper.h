@@ -4,6 +4,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include "core/NodeVisitor.h"
 #include "core/node.h"
@@ -49,6 +50,9 @@ private:
   void initCache();
   void finalizeCache();
   bool isCached(const AbstractNode& node) const;
+  bool copyDump(const State& state, const AbstractNode& node);
+  void insertStart(const AbstractNode& node);
+  void insertEnd(const AbstractNode& node);
 
   NodeCache& cache;
   // Output Formatting options
@@ -58,7 +62,12 @@ private:
   int currindent{0};
   std::shared_ptr<const AbstractNode> root;
   GroupNodeChecker groupChecker;
-  std::ostringstream dumpstream;
+  std::stringstream dumpstream;
+
+  // Shared node whose dump was copied in the prefix visit
+  const AbstractNode *copied{nullptr};
+  // Nodes first dumped with modifiers passed down by a list node
+  std::unordered_set<size_t> inheritedModifiers;
 
 };
 
@@ -0,0 +1,194 @@
+#include "core/ParallelEvaluation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#if ENABLE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include "Feature.h"
+#include "core/Context.h"
+#include "core/EvaluationSession.h"
+#include "core/Value.h"
+#include "utils/StackCheck.h"
+#include "utils/printutils.h"
+
+namespace {
+
+thread_local EvaluationSession *worker_session = nullptr;
+
+// Sets up the calling thread to evaluate in a worker session
+class WorkerScope
+{
+public:
+  WorkerScope(EvaluationSession *session) : stack_check(ParallelEvaluation::WORKER_STACK_LIMIT) {
+    worker_session = session;
+    intercept_messages(&this->messages);
+  }
+  ~WorkerScope() {
+    intercept_messages(nullptr);
+    worker_session = nullptr;
+  }
+  WorkerScope(const WorkerScope&) = delete;
+  WorkerScope& operator=(const WorkerScope&) = delete;
+
+  [[nodiscard]] bool loggedMessages() const { return this->messages > 0; }
+
+private:
+  StackCheck::Scope stack_check;
+  size_t messages = 0;
+};
+
+void forContext(const std::shared_ptr<const Context>& context, const std::string& name, Value value,
+                const ParallelEvaluation::Iteration& iteration, EmbeddedVectorType& output)
+{
+  ContextHandle<Context> iterationContext{Context::create<Context>(context)};
+  iterationContext->set_variable(name, std::move(value));
+  iteration(*iterationContext, output);
+}
+
+/*
+   Copies a value created on a worker thread into session. Vectors from the
+   worker sessions are copied, anything else is shared.
+
+   Arenas aren't thread safe, so vectors of a worker session must not be
+   released by this thread while workers evaluate the next loop.
+ */
+Value copyToSession(const Value& value, EvaluationSession *session, const std::vector<EvaluationSession *>& workers)
+{
+  if (value.type() != Value::Type::VECTOR) return value.clone();
+  const VectorType& vec = value.toVector();
+  if (std::find(workers.begin(), workers.end(), vec.evaluation_session()) == workers.end()) return value.clone();
+  // Deeply nested results are rare, evaluate them sequentially instead
+  if (StackCheck::inst().check()) throw ParallelEvaluation::Aborted();
+  VectorType copy(session);
+  copy.reserve(vec.size());
+  for (const auto& element : vec) copy.emplace_back(copyToSession(element, session, workers));
+  return std::move(copy);
+}
+
+} // namespace
+
+bool ParallelEvaluation::inWorker()
+{
+  return worker_session != nullptr;
+}
+
+bool ParallelEvaluation::isThreadSafe(const std::string& builtin)
+{
+  // Builtins which only compute their result from their arguments
+  static const std::unordered_set<std::string> thread_safe = {
+    "abs", "sign", "min", "max", "sin", "cos", "asin", "acos", "tan", "atan", "atan2",
+    "round", "ceil", "floor", "pow", "sqrt", "exp", "len", "log", "ln", "str", "chr", "ord",
+    "concat", "lookup", "search", "version", "version_num", "norm", "cross",
+    "is_undef", "is_list", "is_num", "is_bool", "is_string", "is_function", "is_object",
+  };
+  return thread_safe.count(builtin) > 0;
+}
+
+EvaluationSession *ParallelEvaluation::sessionForThread(EvaluationSession *session)
+{
+  return session && worker_session ? worker_session : session;
+}
+
+bool ParallelEvaluation::forEach(const std::shared_ptr<const Context>& context, const std::string& name, const Value& values,
+                                 const Iteration& iteration, EmbeddedVectorType& output, bool& aborted)
+{
+#if ENABLE_TBB
+  if (inWorker() || aborted || !Feature::ExperimentalParallelListComprehension.is_enabled() || getenv("OPENSCAD_NO_PARALLEL")) {
+    return false;
+  }
+  EvaluationSession *session = context->session();
+  // Reads of special variables by workers wouldn't be recorded for the memoized call
+  if (session->functionResultCache().isRecording()) return false;
+
+  std::vector<Value> elements;
+  if (values.type() == Value::Type::RANGE) {
+    const RangeType& range = values.toRange();
+    const uint32_t steps = range.numValues();
+    // Larger ranges are rejected with a warning by the sequential loop
+    if (steps < MIN_ITERATIONS || steps >= 1000000) return false;
+    elements.reserve(steps);
+    for (double value : range) elements.emplace_back(value);
+  } else if (values.type() == Value::Type::VECTOR) {
+    const VectorType& vec = values.toVector();
+    if (vec.size() < MIN_ITERATIONS) return false;
+    elements.reserve(vec.size());
+    for (const auto& value : vec) elements.emplace_back(value.clone());
+  } else {
+    return false;
+  }
+
+  // The first iteration is evaluated here, which also flattens the vectors it
+  // indexes, so workers don't have to walk their embedded elements.
+  forContext(context, name, std::move(elements[0]), iteration, output);
+
+  const size_t threads = tbb::this_task_arena::max_concurrency();
+  std::vector<EvaluationSession *> sessions(threads);
+  for (size_t i = 0; i < threads; ++i) sessions[i] = &session->workerSession(i);
+
+  const size_t remaining = elements.size() - 1;
+  const size_t chunks = std::min(remaining, threads * 4);
+  std::vector<std::unique_ptr<EmbeddedVectorType>> results(chunks);
+  std::atomic<bool> failed{false};
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks, 1), [&](const tbb::blocked_range<size_t>& range) {
+    const auto thread = tbb::this_task_arena::current_thread_index();
+    if (thread < 0 || static_cast<size_t>(thread) >= threads) {
+      failed = true;
+      return;
+    }
+    WorkerScope scope(sessions[thread]);
+    for (size_t chunk = range.begin(); chunk != range.end() && !failed; ++chunk) {
+      const size_t begin = 1 + chunk * remaining / chunks;
+      const size_t end = 1 + (chunk + 1) * remaining / chunks;
+      try {
+        auto result = std::make_unique<EmbeddedVectorType>(context->session());
+        for (size_t i = begin; i < end && !failed; ++i) {
+          forContext(context, name, elements[i].clone(), iteration, *result);
+        }
+        results[chunk] = std::move(result);
+      } catch (...) {
+        failed = true;
+      }
+      if (scope.loggedMessages()) failed = true;
+    }
+  });
+
+  // Results are copied out of the worker sessions while no worker runs, and
+  // the originals released here.
+  EmbeddedVectorType copied(session);
+  if (!failed) {
+    try {
+      for (const auto& result : results) {
+        for (const auto& element : *result) copied.emplace_back(copyToSession(element, session, sessions));
+      }
+    } catch (const Aborted&) {
+      failed = true;
+    }
+  }
+  results.clear();
+
+  if (failed) {
+    aborted = true;
+    for (size_t i = 1; i < elements.size(); ++i) {
+      forContext(context, name, std::move(elements[i]), iteration, output);
+    }
+  } else {
+    output.emplace_back(std::move(copied));
+  }
+  return true;
+#else
+  return false;
+#endif // if ENABLE_TBB
+}
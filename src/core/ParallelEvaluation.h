@@ -0,0 +1,58 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "core/Value.h"
+
+class Context;
+class EvaluationSession;
+
+/*!
+   Evaluates the iterations of large for() list comprehensions on several threads.
+
+   Evaluation is speculative: each worker thread evaluates in a session of its
+   own, which reads the special variables of the session it was started from,
+   and anything which must happen in program order aborts it. That is logging
+   a message, calling a builtin function which isn't known to be thread safe
+   (e.g. rands()) or creating a function literal. The results of all workers
+   are then discarded and the loop is evaluated sequentially, so the output
+   and results are the same as without parallel evaluation.
+
+   Values shared with the starting session are only read on worker threads.
+   Vectors with embedded elements aren't flattened there and search indexes
+   aren't built, see VectorType::operator[] and VectorIndex::worthIndexing().
+   Arenas aren't thread safe either, so the results are copied into the
+   starting session once all workers are done.
+ */
+class ParallelEvaluation
+{
+public:
+  // Thrown on worker threads when an iteration must be evaluated sequentially
+  struct Aborted {};
+
+  using Iteration = std::function<void (const std::shared_ptr<const Context>&, EmbeddedVectorType&)>;
+
+  // Loops with fewer iterations are evaluated sequentially
+  constexpr static size_t MIN_ITERATIONS = 256;
+  // Worker threads have smaller stacks than the main thread
+  constexpr static unsigned long WORKER_STACK_LIMIT = 2 * 1024 * 1024;
+
+  static bool inWorker();
+  static void requireSequential() { if (inWorker()) throw Aborted(); }
+  static bool isThreadSafe(const std::string& builtin);
+  // The session in which the calling thread creates contexts and vectors for the given session
+  static EvaluationSession *sessionForThread(EvaluationSession *session);
+
+  /*!
+     Evaluates iteration for each value of a range or vector, with the loop
+     variable set in a child context of context, appending to output in order.
+
+     Returns false if the loop isn't evaluated in parallel, without having
+     evaluated any iteration. Sets aborted if the loop had to be evaluated
+     sequentially after all, so it isn't tried again.
+   */
+  static bool forEach(const std::shared_ptr<const Context>& context, const std::string& name, const Value& values,
+                      const Iteration& iteration, EmbeddedVectorType& output, bool& aborted);
+};
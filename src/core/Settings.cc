@@ -228,6 +228,7 @@ SettingsEntryList<LocalAppParameter> Settings::localAppParameterList("printing",
 
 SettingsEntryEnum<std::string> Settings::renderBackend3D("advanced", "renderBackend3D", {
   {"CGAL",     "cgal",     "CGAL (old/slow)"},
+  {"CGAL-Corefinement", "cgal-corefinement", "CGAL corefinement (exact, Nef fallback)"},
   {"Manifold", "manifold", "Manifold (new/fast)"}
 }, "CGAL");
 SettingsEntryEnum<std::string> Settings::toolbarExport3D("advanced", "toolbarExport3D", createFileFormatItems(fileformat::all3D()), fileformat::info(FileFormat::ASCII_STL).description);
@@ -30,7 +30,6 @@
 #include "core/ModuleInstantiation.h"
 #include "core/node.h"
 #include "geometry/PolySet.h"
-#include "geometry/PolySetBuilder.h"
 #include "core/Builtins.h"
 #include "core/Children.h"
 #include "core/Parameters.h"
@@ -50,10 +49,7 @@
 #include <sstream>
 #include <fstream>
 #include <vector>
-#include <unordered_map>
 
-#include <boost/functional/hash.hpp>
-#include <boost/tokenizer.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/assign/std/vector.hpp>
@@ -164,29 +160,36 @@ img_data_t SurfaceNode::read_dat(std::string filename) const
   int lines = 0, columns = 0;
   double min_val = 1; // this balances out with the (min_val-1) inside createGeometry, to match old behavior
 
-  using tokenizer = boost::tokenizer<boost::char_separator<char>>;
-  boost::char_separator<char> sep(" \t");
-
-  // We use an unordered map because the data file may not be rectangular,
-  // and we may need to fill in some bits.
-  using unordered_image_data_t = std::unordered_map<std::pair<int, int>, double, boost::hash<std::pair<int, int>>>;
-  unordered_image_data_t unordered_data;
+  // The data file may not be rectangular, so rows are stored as they are read
+  // and filled up with zeros afterwards.
+  std::vector<double> values;
+  std::vector<size_t> row_starts;
 
+  std::string line;
   while (!stream.eof()) {
-    std::string line;
+    line.clear();
     while (!stream.eof() && (line.size() == 0 || line[0] == '#')) {
       std::getline(stream, line);
       boost::trim(line);
     }
     if (line.size() == 0 && stream.eof()) break;
 
+    row_starts.push_back(values.size());
     int col = 0;
-    tokenizer tokens(line, sep);
     try {
-      for (const auto& token : tokens) {
-        auto v = boost::lexical_cast<double>(token);
-        unordered_data[ std::make_pair(lines, col++) ] = v;
-        if (col > columns) columns = col;
+      // Tokens are separated by spaces and tabs
+      const char *pos = line.data();
+      const char *end = pos + line.size();
+      while (pos < end) {
+        if (*pos == ' ' || *pos == '\t') {
+          ++pos;
+          continue;
+        }
+        const char *token = pos;
+        while (pos < end && *pos != ' ' && *pos != '\t') ++pos;
+        auto v = boost::lexical_cast<double>(token, pos - token);
+        values.push_back(v);
+        if (++col > columns) columns = col;
         min_val = std::min(v, min_val);
       }
     } catch (const boost::bad_lexical_cast& blc) {
@@ -198,22 +201,29 @@ img_data_t SurfaceNode::read_dat(std::string filename) const
 
     lines++;
   }
+  row_starts.push_back(values.size());
 
   data.width = columns;
   data.height = lines;
   data.min_val = min_val;
 
-  // Now convert the unordered, possibly non-rectangular data into a well ordered vector
-  // for faster access and reduced memory usage.
   data.resize( (size_t)lines * columns);
-  for (int i = 0; i < lines; ++i)
-    for (int j = 0; j < columns; ++j)
-      data[ i * columns + j ] = unordered_data[std::make_pair(i, j)];
+  for (int i = 0; i < lines; ++i) {
+    const size_t row_size = row_starts[i + 1] - row_starts[i];
+    for (int j = 0; j < columns; ++j) {
+      data[ i * columns + j ] = static_cast<size_t>(j) < row_size ? values[row_starts[i] + j] : 0;
+    }
+  }
 
   return data;
 }
 
-// FIXME: Look for faster way to generate PolySet directly
+/*
+   The mesh is generated from the grid directly, rather than looking up
+   every corner of every polygon by its coordinates. Vertices are numbered
+   in the order in which they're first used by the polygons, so the result
+   is the same as when building it from polygon coordinates.
+ */
 std::unique_ptr<const Geometry> SurfaceNode::createGeometry() const
 {
   auto data = read_png_or_dat(filename);
@@ -222,14 +232,44 @@ std::unique_ptr<const Geometry> SurfaceNode::createGeometry() const
   int columns = data.width;
   double min_val = data.min_value() - 1; // make the bottom solid, and match old code
 
-  // reserve the polygon vector size so we don't have to reallocate as often
-
   double ox = center ? -(columns - 1) / 2.0 : 0;
   double oy = center ? -(lines - 1) / 2.0 : 0;
 
-  int num_indices = (lines - 1) * (columns - 1) * 4 + (lines - 1) * 2 + (columns - 1) * 2 + 1;
-  PolySetBuilder builder(0, num_indices);
-  builder.setConvexity(convexity);
+  auto polyset = std::make_unique<PolySet>(3);
+  polyset->setConvexity(convexity);
+  auto& vertices = polyset->vertices;
+  auto& indices = polyset->indices;
+
+  const size_t cells = lines > 1 && columns > 1 ? (size_t)(lines - 1) * (columns - 1) : 0;
+  // Positions along the perimeter of the bottom; with a single line or column, both sides share them
+  const size_t perimeter = 2 * (size_t)columns + 2 * (size_t)std::max(lines - 2, 0);
+  vertices.reserve((size_t)lines * columns + cells + perimeter);
+  indices.reserve(cells * 4 + 2 * (size_t)std::max(lines - 1, 0) + 2 * (size_t)std::max(columns - 1, 0) + 1);
+
+  std::vector<int> grid_indices((size_t)lines * columns, -1);
+  auto grid = [&](int x, int y) {
+    int& index = grid_indices[x + (size_t)y * columns];
+    if (index < 0) {
+      index = static_cast<int>(vertices.size());
+      vertices.emplace_back(ox + x, oy + y, data[ x + y * columns ]);
+    }
+    return index;
+  };
+  std::vector<int> bottom_indices(perimeter, -1);
+  auto bottom = [&](int x, int y) {
+    size_t pos;
+    if (y == 0) pos = x;
+    else if (y == lines - 1) pos = columns + x;
+    else if (x == 0) pos = 2 * (size_t)columns + (y - 1);
+    else pos = 2 * (size_t)columns + (lines - 2) + (y - 1);
+    int& index = bottom_indices[pos];
+    if (index < 0) {
+      index = static_cast<int>(vertices.size());
+      vertices.emplace_back(ox + x, oy + y, min_val);
+    }
+    return index;
+  };
+
   // the bulk of the heightmap
   for (int i = 1; i < lines; ++i)
     for (int j = 1; j < columns; ++j) {
@@ -240,90 +280,48 @@ std::unique_ptr<const Geometry> SurfaceNode::createGeometry() const
 
       double vx = (v1 + v2 + v3 + v4) / 4;
 
-      builder.appendPolygon({
-                Vector3d(ox + j - 1, oy + i - 1, v1),
-                Vector3d(ox + j, oy + i - 1, v2),
-                Vector3d(ox + j - 0.5, oy + i - 0.5, vx)
-                });
-
-      builder.appendPolygon({
-                Vector3d(ox + j, oy + i - 1, v2),
-                Vector3d(ox + j, oy + i, v4),
-                Vector3d(ox + j - 0.5, oy + i - 0.5, vx)
-                });
-
-      builder.appendPolygon({
-                Vector3d(ox + j, oy + i, v4),
-                Vector3d(ox + j - 1, oy + i, v3),
-                Vector3d(ox + j - 0.5, oy + i - 0.5, vx)
-                });
-
-      builder.appendPolygon({
-                Vector3d(ox + j - 1, oy + i, v3),
-                Vector3d(ox + j - 1, oy + i - 1, v1),
-                Vector3d(ox + j - 0.5, oy + i - 0.5, vx)
-                });
+      const int i1 = grid(j - 1, i - 1);
+      const int i2 = grid(j, i - 1);
+      const int ix = static_cast<int>(vertices.size());
+      vertices.emplace_back(ox + j - 0.5, oy + i - 0.5, vx);
+      const int i4 = grid(j, i);
+      const int i3 = grid(j - 1, i);
+
+      indices.push_back({i1, i2, ix});
+      indices.push_back({i2, i4, ix});
+      indices.push_back({i4, i3, ix});
+      indices.push_back({i3, i1, ix});
     }
 
   // edges along Y
   for (int i = 1; i < lines; ++i) {
-    double v1 = data[ (0) + (i - 1) * columns ];
-    double v2 = data[ (0) + (i) * columns ];
-    double v3 = data[ (columns - 1) + (i - 1) * columns ];
-    double v4 = data[ (columns - 1) + (i) * columns ];
-
-
-    builder.appendPolygon({
-        Vector3d(ox + 0, oy + i - 1, min_val),
-        Vector3d(ox + 0, oy + i - 1, v1),
-        Vector3d(ox + 0, oy + i, v2),
-        Vector3d(ox + 0, oy + i, min_val)
-    });
-
-    builder.appendPolygon({
-        Vector3d(ox + columns - 1, oy + i, min_val),
-        Vector3d(ox + columns - 1, oy + i, v4),
-        Vector3d(ox + columns - 1, oy + i - 1, v3),
-        Vector3d(ox + columns - 1, oy + i - 1, min_val)
-    });
+    indices.push_back({bottom(0, i - 1), grid(0, i - 1), grid(0, i), bottom(0, i)});
+    indices.push_back({bottom(columns - 1, i), grid(columns - 1, i), grid(columns - 1, i - 1), bottom(columns - 1, i - 1)});
   }
 
   // edges along X
   for (int i = 1; i < columns; ++i) {
-    double v1 = data[ (i - 1) + (0) * columns ];
-    double v2 = data[ (i) + (0) * columns ];
-    double v3 = data[ (i - 1) + (lines - 1) * columns ];
-    double v4 = data[ (i) + (lines - 1) * columns ];
-
-    builder.appendPolygon({
-        Vector3d(ox + i, oy + 0, min_val),
-        Vector3d(ox + i, oy + 0, v2),
-        Vector3d(ox + i - 1, oy + 0, v1),
-        Vector3d(ox + i - 1, oy + 0, min_val)
-    });
-
-    builder.appendPolygon({
-        Vector3d(ox + i - 1, oy + lines - 1, min_val),
-        Vector3d(ox + i - 1, oy + lines - 1, v3),
-        Vector3d(ox + i, oy + lines - 1, v4),
-        Vector3d(ox + i, oy + lines - 1, min_val)
-    });
+    indices.push_back({bottom(i, 0), grid(i, 0), grid(i - 1, 0), bottom(i - 1, 0)});
+    indices.push_back({bottom(i - 1, lines - 1), grid(i - 1, lines - 1), grid(i, lines - 1), bottom(i, lines - 1)});
   }
 
   // the bottom of the shape (one less than the real minimum value), making it a solid volume
   if (columns > 1 && lines > 1) {
-    builder.beginPolygon(2 * (columns - 1) + 2 * (lines - 1) );
+    IndexedFace face;
+    face.reserve(2 * (columns - 1) + 2 * (lines - 1));
     for (int i = 0; i < lines - 1; ++i)
-      builder.addVertex(Vector3d(ox + 0, oy + i, min_val));
+      face.push_back(bottom(0, i));
     for (int i = 0; i < columns - 1; ++i)
-      builder.addVertex(Vector3d(ox + i, oy + lines - 1, min_val));
+      face.push_back(bottom(i, lines - 1));
     for (int i = lines - 1; i > 0; i--)
-      builder.addVertex(Vector3d(ox + columns - 1, oy + i, min_val));
+      face.push_back(bottom(columns - 1, i));
     for (int i = columns - 1; i > 0; i--)
-      builder.addVertex(Vector3d(ox + i, oy + 0, min_val));
+      face.push_back(bottom(i, 0));
+    indices.push_back(std::move(face));
   }
 
-  return builder.build();
+  polyset->setTriangular(indices.empty());
+  return polyset;
 }
 
 std::string SurfaceNode::toString() const
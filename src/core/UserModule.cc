@@ -30,7 +30,10 @@
 #include <memory>
 #include <vector>
 
+#include "Feature.h"
 #include "core/AST.h"
+#include "core/EvaluationSession.h"
+#include "core/MemoKey.h"
 #include "core/ModuleInstantiation.h"
 #include "core/node.h"
 #include "utils/exceptions.h"
@@ -40,6 +43,7 @@
 #include "utils/printutils.h"
 #include "utils/compiler_specific.h"
 #include <cstddef>
+#include <map>
 #include <sstream>
 #include <string>
 
@@ -79,6 +83,41 @@ static void NOINLINE print_trace(const UserModule *mod, const std::shared_ptr<co
       );
 }
 
+/*!
+   Builds the key under which a call's node subtree is memoized, or returns an
+   invalid key if the call can't be memoized.
+
+   Without children, the subtree only depends on the module, the lexical
+   variables of its context (parameters and assignments in the body, which
+   were evaluated already), and the special variables visible on the stack.
+   Lexical variables from outside the module are only constant for modules
+   defined at file level. The module instantiation takes part in the key since
+   it carries the modifiers and locations of the subtree's root node.
+ */
+static MemoKey make_instance_key(const UserModule *mod, const ModuleInstantiation *inst,
+                                 const std::shared_ptr<const Context>& defining_context,
+                                 const UserModuleContext& module_context)
+{
+  MemoKey key;
+  if (!inst->scope.moduleInstantiations.empty() ||
+      !std::dynamic_pointer_cast<const FileContext>(defining_context)) {
+    key.invalidate();
+    return key;
+  }
+  key.add(mod);
+  key.add(inst);
+  std::map<std::string, const Value *> variables;
+  for (const auto& variable : module_context.lexical_variable_map()) {
+    variables.emplace(variable.first, &variable.second);
+  }
+  for (const auto& variable : variables) {
+    key.add(variable.first);
+    key.add(*variable.second);
+  }
+  module_context.session()->add_special_variables(key);
+  return key;
+}
+
 std::shared_ptr<AbstractNode> UserModule::instantiate(const std::shared_ptr<const Context>& defining_context, const ModuleInstantiation *inst, const std::shared_ptr<const Context>& context) const
 {
   if (StackCheck::inst().check()) {
@@ -100,6 +139,21 @@ std::shared_ptr<AbstractNode> UserModule::instantiate(const std::shared_ptr<cons
   PRINTDB("%s", module_context->dump());
 #endif
 
+  // Memoized subtrees are shared by all calls with the same key. A result is
+  // only memoized if instantiating it had no observable side effects.
+  EvaluationSession *session = module_context->session();
+  MemoKey key;
+  if (Feature::ExperimentalModuleMemoization.is_enabled()) {
+    key = make_instance_key(this, inst, defining_context, **module_context);
+  } else {
+    key.invalidate();
+  }
+  if (key.valid()) {
+    if (auto node = session->moduleInstanceCache().find(key.str())) return node;
+  }
+  const size_t impure_operations = session->impure_operation_count();
+  const size_t messages = print_message_count();
+
   std::shared_ptr<AbstractNode> ret;
   try{
     ret = this->body.instantiateModules(*module_context, std::make_shared<GroupNode>(inst, std::string("module ") + this->name));
@@ -110,6 +164,9 @@ std::shared_ptr<AbstractNode> UserModule::instantiate(const std::shared_ptr<cons
     }
     throw;
   }
+  if (key.valid() && session->impure_operation_count() == impure_operations && print_message_count() == messages) {
+    session->moduleInstanceCache().insert(key.str(), ret);
+  }
   return ret;
 }
 
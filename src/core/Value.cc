@@ -42,6 +42,7 @@
 #include <boost/lexical_cast.hpp>
 
 #include "core/EvaluationSession.h"
+#include "core/ParallelEvaluation.h"
 #include "io/fileutils.h"
 #include "utils/printutils.h"
 #include "utils/StackCheck.h"
@@ -529,16 +530,28 @@ std::string Value::chrString() const
   return std::visit(chr_visitor(), this->value);
 }
 
+// Vectors of a session are allocated from its arena, see VectorObjectDeleter for their release.
+// Worker threads allocate from the arena of their own session.
+std::shared_ptr<VectorType::VectorObject> VectorType::createObject(EvaluationSession *session)
+{
+  session = ParallelEvaluation::sessionForThread(session);
+  if (!session) {
+    return std::shared_ptr<VectorObject>(new VectorObject(), VectorObjectDeleter{});
+  }
+  auto& arena = session->arena();
+  auto *object = new (arena.allocate(sizeof(VectorObject))) VectorObject();
+  object->evaluation_session = session;
+  return std::shared_ptr<VectorObject>(object, VectorObjectDeleter{&arena}, ArenaAllocator<VectorObject>(arena));
+}
+
 VectorType::VectorType(EvaluationSession *session) :
-  ptr(std::shared_ptr<VectorObject>(new VectorObject(), VectorObjectDeleter() ))
+  ptr(createObject(session))
 {
-  ptr->evaluation_session = session;
 }
 
 VectorType::VectorType(class EvaluationSession *session, double x, double y, double z) :
-  ptr(std::shared_ptr<VectorObject>(new VectorObject(), VectorObjectDeleter() ))
+  ptr(createObject(session))
 {
-  ptr->evaluation_session = session;
   emplace_back(x);
   emplace_back(y);
   emplace_back(z);
@@ -546,6 +559,7 @@ VectorType::VectorType(class EvaluationSession *session, double x, double y, dou
 
 void VectorType::emplace_back(Value&& val)
 {
+  if (ptr->index) ptr->index.reset();
   if (val.type() == Value::Type::EMBEDDED_VECTOR) {
     emplace_back(std::move(val.toEmbeddedVectorNonConst()));
   } else {
@@ -559,6 +573,7 @@ void VectorType::emplace_back(Value&& val)
 // Specialized handler for EmbeddedVectorTypes
 void VectorType::emplace_back(EmbeddedVectorType&& mbed)
 {
+  if (ptr->index) ptr->index.reset();
   if (mbed.size() > 1) {
     // embed_excess represents how many to add to vec.size() to get the total elements after flattening,
     // the embedded vector itself already counts towards an element in the parent's size, so subtract 1 from its size.
@@ -592,10 +607,24 @@ void VectorType::flatten() const
   ptr->vec = std::move(ret);
 }
 
+bool VectorType::ownedByThread() const
+{
+  if (!ParallelEvaluation::inWorker()) return true;
+  EvaluationSession *session = ptr->evaluation_session;
+  return session && session == ParallelEvaluation::sessionForThread(session);
+}
+
+const Value& VectorType::embeddedElement(size_t idx) const
+{
+  auto it = begin();
+  for (size_t i = 0; i < idx; ++i) ++it;
+  return *it;
+}
+
 void VectorType::VectorObjectDeleter::operator()(VectorObject *v)
 {
-  if (v->evaluation_session) {
-    v->evaluation_session->accounting().removeVectorElement(v->vec.size());
+  if (arena) {
+    arena->accounting().removeVectorElement(v->vec.size());
   }
 
   VectorObject *orig = v;
@@ -619,7 +648,12 @@ void VectorType::VectorObjectDeleter::operator()(VectorObject *v)
     v = curr.get();
     purge.pop_back();
   }
-  delete orig;
+  if (arena) {
+    orig->~VectorObject();
+    arena->deallocate(orig, sizeof(VectorObject));
+  } else {
+    delete orig;
+  }
 }
 
 const VectorType& Value::toVector() const
@@ -21,6 +21,7 @@ class tostring_visitor;
 class tostream_visitor;
 class Expression;
 class Value;
+class VectorIndex;
 
 class QuotedString : public std::string
 {
@@ -124,6 +125,7 @@ protected:
       vec_t vec;
       size_type embed_excess = 0; // Keep count of the number of embedded elements *excess of* vec.size()
       class EvaluationSession *evaluation_session = nullptr; // Used for heap size bookkeeping. May be null for vectors of known small maximum size.
+      std::shared_ptr<VectorIndex> index; // Built on demand by search() and lookup(), see VectorIndex
       [[nodiscard]] size_type size() const { return vec.size() + embed_excess;  }
       [[nodiscard]] bool empty() const { return vec.empty() && embed_excess == 0;  }
     };
@@ -136,13 +138,18 @@ protected:
     // of destructing a very large list of nested embedded vectors, such as from a
     // recursive function which concats one element at a time.
     // (A similar solution can also be seen with CSGNode.h:CSGOperationDeleter).
+    // Vectors allocated from an arena are released to it, which may outlive their session.
     struct VectorObjectDeleter {
+      class EvaluationArena *arena = nullptr;
       void operator()(VectorObject *vec);
     };
     void flatten() const; // flatten replaces VectorObject::vec with a new vector
                           // where any embedded elements are copied directly into the top level vec,
                           // leaving only true elements for straightforward indexing by operator[].
+    [[nodiscard]] bool ownedByThread() const;
+    [[nodiscard]] const Value& embeddedElement(size_t idx) const; // finds an element without flattening
     explicit VectorType(const std::shared_ptr<VectorObject>& copy) : ptr(copy) { } // called by clone()
+    static std::shared_ptr<VectorObject> createObject(class EvaluationSession *session);
 public:
     using size_type = VectorObject::size_type;
     static const VectorType EMPTY;
@@ -227,7 +234,11 @@ public:
     // const accesses to VectorObject require .clone to be move-able
     const Value& operator[](size_t idx) const {
       if (idx < this->size()) {
-        if (ptr->embed_excess) flatten();
+        if (ptr->embed_excess) {
+          // Vectors of other threads' sessions may be read concurrently, see ParallelEvaluation
+          if (!ownedByThread()) return embeddedElement(idx);
+          flatten();
+        }
         return ptr->vec[idx];
       } else {
         return Value::undefined;
@@ -240,6 +251,8 @@ public:
     Value operator<=(const VectorType& v) const;
     Value operator>=(const VectorType& v) const;
     [[nodiscard]] class EvaluationSession *evaluation_session() const { return ptr->evaluation_session; }
+    // Search index shared by all copies of this vector
+    [[nodiscard]] VectorIndex& index() const;
 
     void emplace_back(Value&& val);
     void emplace_back(EmbeddedVectorType&& mbed);
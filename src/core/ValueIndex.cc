@@ -0,0 +1,141 @@
+#include "core/ValueIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/ParallelEvaluation.h"
+#include "core/Value.h"
+
+VectorIndex& VectorType::index() const
+{
+  if (!ptr->index) ptr->index = std::make_shared<VectorIndex>();
+  return *ptr->index;
+}
+
+StringIndex& str_utf8_wrapper::index() const
+{
+  if (!str_ptr->index) str_ptr->index = std::make_shared<StringIndex>();
+  return *str_ptr->index;
+}
+
+namespace {
+
+template <typename K>
+const std::vector<size_t> *find_rows(const std::unordered_map<K, std::vector<size_t>>& map, const K& key)
+{
+  auto it = map.find(key);
+  return it == map.end() ? nullptr : &it->second;
+}
+
+// Indexes a number the way operator== compares them
+bool number_key(double& d)
+{
+  if (std::isnan(d)) return false;
+  if (d == 0) d = 0; // -0 == 0
+  return true;
+}
+
+} // namespace
+
+bool VectorIndex::worthIndexing(size_t size)
+{
+  return size >= MIN_SIZE && !ParallelEvaluation::inWorker();
+}
+
+const std::vector<size_t> *VectorIndex::Column::find(const Value& value) const
+{
+  if (value.type() == Value::Type::NUMBER) {
+    double d = value.toDouble();
+    return number_key(d) ? find_rows(this->numbers, d) : nullptr;
+  } else if (value.type() == Value::Type::STRING) {
+    return find_rows(this->strings, value.toString());
+  }
+  return nullptr;
+}
+
+const std::vector<size_t> *VectorIndex::Column::findFirstChar(uint32_t c) const
+{
+  return find_rows(this->first_chars, c);
+}
+
+const VectorIndex::Column *VectorIndex::column(const VectorType& table, size_t col)
+{
+  auto it = this->columns.find(col);
+  if (it != this->columns.end()) return &it->second;
+  if (!queriedBefore()) return nullptr;
+
+  // Mirrors the comparisons of the linear search in builtin_search()
+  Column& column = this->columns[col];
+  column.first_chars_end = table.size();
+  size_t row = 0;
+  for (const auto& element : table) {
+    const auto& entry = element.toVector();
+    const Value *value = nullptr;
+    if (col == 0 && element.type() != Value::Type::VECTOR) {
+      value = &element;
+    } else if (col < entry.size()) {
+      value = &entry[col];
+    }
+    if (value && value->type() == Value::Type::NUMBER) {
+      double d = value->toDouble();
+      if (number_key(d)) column.numbers[d].push_back(row);
+    } else if (value && value->type() == Value::Type::STRING) {
+      column.strings[value->toString()].push_back(row);
+    }
+
+    if (column.first_chars_end == table.size()) {
+      if (col < entry.size() && entry[col].type() == Value::Type::STRING) {
+        column.first_chars[entry[col].toStrUtf8Wrapper().get_utf8_char()].push_back(row);
+      } else {
+        column.first_chars_end = row;
+      }
+    }
+    ++row;
+  }
+  return &column;
+}
+
+const std::vector<VectorIndex::LookupEntry> *VectorIndex::lookupTable(const VectorType& table)
+{
+  if (this->lookup_indexed) return this->lookup_table.get();
+  if (!queriedBefore()) return nullptr;
+
+  this->lookup_indexed = true;
+  auto entries = std::make_unique<std::vector<LookupEntry>>();
+  entries->reserve(table.size());
+  for (const auto& element : table) {
+    double key, value;
+    if (element.getVec2(key, value)) {
+      // NaN keys never compare, so lookup() depends on where they are in the table
+      if (std::isnan(key)) return nullptr;
+      entries->push_back({key, value});
+    }
+  }
+  std::stable_sort(entries->begin(), entries->end(), [](const LookupEntry& a, const LookupEntry& b) {
+    return a.key < b.key;
+  });
+  this->lookup_table = std::move(entries);
+  return this->lookup_table.get();
+}
+
+bool StringIndex::find(const str_utf8_wrapper& str, uint32_t c, const std::vector<size_t> *& found)
+{
+  if (!this->positions) {
+    if (this->queries++ == 0) return false;
+    this->positions = std::make_unique<std::unordered_map<uint32_t, std::vector<size_t>>>();
+    size_t pos = 0;
+    for (const auto ch : str) {
+      if (!ch.empty()) (*this->positions)[ch.get_utf8_char()].push_back(pos);
+      ++pos;
+    }
+  }
+  found = find_rows(*this->positions, c);
+  return true;
+}
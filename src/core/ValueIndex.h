@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/Value.h"
+
+/*!
+   Indexes for repeated search() and lookup() queries on the same vector.
+
+   Vectors don't change once they're shared, so the index is attached to the
+   shared vector object and lives as long as it. It is only built when a vector
+   is queried for the second time, so one-off queries on temporary vectors keep
+   the cost of a linear scan.
+ */
+class VectorIndex
+{
+public:
+  // Rows of a vector by the value in one of its columns, in ascending order
+  struct Column {
+    const std::vector<size_t> *find(const Value& value) const;
+    const std::vector<size_t> *findFirstChar(uint32_t c) const;
+
+    std::unordered_map<double, std::vector<size_t>> numbers; // -0 is stored as 0, NaN never matches
+    std::unordered_map<std::string, std::vector<size_t>> strings;
+    // First code points of strings, as compared by search() for string keys
+    std::unordered_map<uint32_t, std::vector<size_t>> first_chars;
+    // Rows from here on aren't in first_chars, as a linear search warns about or fails on this row
+    size_t first_chars_end = 0;
+  };
+
+  struct LookupEntry {
+    double key;
+    double value;
+  };
+
+  // Tables smaller than this are always scanned
+  constexpr static size_t MIN_SIZE = 8;
+  // Indexes aren't built on worker threads, which may share the vector with other threads
+  static bool worthIndexing(size_t size);
+
+  // Returns nullptr if the vector hasn't been queried before.
+  const Column *column(const VectorType& table, size_t col);
+  // Valid lookup() entries sorted by key, in table order for equal keys.
+  // Returns nullptr if the vector hasn't been queried before, or has NaN keys.
+  const std::vector<LookupEntry> *lookupTable(const VectorType& table);
+
+private:
+  bool queriedBefore() { return this->queries++ > 0; }
+
+  size_t queries = 0;
+  std::unordered_map<size_t, Column> columns;
+  std::unique_ptr<std::vector<LookupEntry>> lookup_table;
+  bool lookup_indexed = false;
+};
+
+/*!
+   Positions of each code point in a string, for searching a string in another
+   string. Built like VectorIndex, on the second query of a string.
+ */
+class StringIndex
+{
+public:
+  // Returns false if the string hasn't been queried before.
+  bool find(const str_utf8_wrapper& str, uint32_t c, const std::vector<size_t> *& positions);
+
+private:
+  size_t queries = 0;
+  std::unique_ptr<std::unordered_map<uint32_t, std::vector<size_t>>> positions;
+};
@@ -29,11 +29,13 @@
 #include "core/Arguments.h"
 #include "core/Expression.h"
 #include "core/Builtins.h"
+#include "core/EvaluationSession.h"
 #include "utils/printutils.h"
 #include "core/UserModule.h"
 #include "utils/degree_trig.h"
 #include "core/FreetypeRenderer.h"
 #include "core/Parameters.h"
+#include "core/ValueIndex.h"
 #include "io/import.h"
 #include "io/fileutils.h"
 
@@ -167,6 +169,8 @@ Value builtin_rands(Arguments arguments, const Location& loc)
   }
   auto numresults = boost_numeric_cast<size_t, double>(numresultsd);
 
+  // Seeded or not, the shared generator state changes
+  arguments.session()->record_impure_operation();
   if (arguments.size() > 3) {
     auto seed = static_cast<uint32_t>(hash_floating_point(arguments[3]->toDouble() ));
     deterministic_rng.seed(seed);
@@ -458,16 +462,34 @@ Value builtin_lookup(Arguments arguments, const Location& loc)
   high_p = low_p;
   high_v = low_v;
 
-  for (++it; it != vec.end(); ++it) {
-    double this_p, this_v;
-    if (it->getVec2(this_p, this_v)) {
-      if (this_p <= p && (this_p > low_p || low_p > p)) {
-        low_p = this_p;
-        low_v = this_v;
-      }
-      if (this_p >= p && (this_p < high_p || high_p < p)) {
-        high_p = this_p;
-        high_v = this_v;
+  const auto *entries = VectorIndex::worthIndexing(vec.size()) ? vec.index().lookupTable(vec) : nullptr;
+  if (entries) {
+    // Same result as the scan below: the first entry with the greatest key <= p,
+    // and the first entry with the smallest key >= p.
+    using Entry = VectorIndex::LookupEntry;
+    auto upper = std::upper_bound(entries->begin(), entries->end(), p, [](double key, const Entry& e) { return key < e.key; });
+    if (upper != entries->begin()) {
+      auto low = std::lower_bound(entries->begin(), upper, std::prev(upper)->key, [](const Entry& e, double key) { return e.key < key; });
+      low_p = low->key;
+      low_v = low->value;
+    }
+    auto high = std::lower_bound(entries->begin(), entries->end(), p, [](const Entry& e, double key) { return e.key < key; });
+    if (high != entries->end()) {
+      high_p = high->key;
+      high_v = high->value;
+    }
+  } else {
+    for (++it; it != vec.end(); ++it) {
+      double this_p, this_v;
+      if (it->getVec2(this_p, this_v)) {
+        if (this_p <= p && (this_p > low_p || low_p > p)) {
+          low_p = this_p;
+          low_v = this_v;
+        }
+        if (this_p >= p && (this_p < high_p || high_p < p)) {
+          high_p = this_p;
+          high_v = this_v;
+        }
       }
     }
   }
@@ -537,22 +559,34 @@ static VectorType search(
   //Unicode glyph count for the length
   size_t findThisSize = find.get_utf8_strlen();
   size_t searchTableSize = table.get_utf8_strlen();
+  StringIndex *index = VectorIndex::worthIndexing(searchTableSize) ? &table.index() : nullptr;
   for (size_t i = 0; i < findThisSize; ++i) {
     unsigned int matchCount = 0;
     VectorType resultvec(session);
     const auto ft = find[i];
-    for (size_t j = 0; j < searchTableSize; ++j) {
-      const auto st = table[j];
-      if (!ft.empty() && !st.empty() && ft.get_utf8_char() == st.get_utf8_char()) {
-        matchCount++;
-        if (num_returns_per_match == 1) {
-          returnvec.emplace_back(double(j));
-          break;
-        } else {
-          resultvec.emplace_back(double(j));
+    // Returns false when no more matches are needed
+    auto add_match = [&](size_t j) {
+      matchCount++;
+      if (num_returns_per_match == 1) {
+        returnvec.emplace_back(double(j));
+        return false;
+      } else {
+        resultvec.emplace_back(double(j));
+      }
+      return !(num_returns_per_match > 1 && matchCount >= num_returns_per_match);
+    };
+    const std::vector<size_t> *positions = nullptr;
+    if (index && !ft.empty() && index->find(table, ft.get_utf8_char(), positions)) {
+      if (positions) {
+        for (size_t j : *positions) {
+          if (!add_match(j)) break;
         }
-        if (num_returns_per_match > 1 && matchCount >= num_returns_per_match) {
-          break;
+      }
+    } else {
+      for (size_t j = 0; j < searchTableSize; ++j) {
+        const auto st = table[j];
+        if (!ft.empty() && !st.empty() && ft.get_utf8_char() == st.get_utf8_char()) {
+          if (!add_match(j)) break;
         }
       }
     }
@@ -568,6 +602,7 @@ static VectorType search(
   const VectorType& table,
   unsigned int num_returns_per_match,
   unsigned int index_col_num,
+  const VectorIndex::Column *column,
   const Location& loc,
   EvaluationSession *session
   ) {
@@ -579,22 +614,35 @@ static VectorType search(
     unsigned int matchCount = 0;
     VectorType resultvec(session);
     const auto ft = find[i];
-    for (size_t j = 0; j < searchTableSize; ++j) {
-      const auto& entryVec = table[j].toVector();
-      if (entryVec.size() <= index_col_num) {
-        LOG(message_group::Warning, loc, session->documentRoot(), "Invalid entry in search vector at index %1$d, required number of values in the entry: %2$d. Invalid entry: %3$s", j, (index_col_num + 1), table[j].toEchoStringNoThrow());
-        return {session};
+    // Returns false when no more matches are needed
+    auto add_match = [&](size_t j) {
+      matchCount++;
+      if (num_returns_per_match == 1) {
+        returnvec.emplace_back(double(j));
+        return false;
+      } else {
+        resultvec.emplace_back(double(j));
       }
-      if (!ft.empty() && ft.get_utf8_char() == entryVec[index_col_num].toStrUtf8Wrapper().get_utf8_char()) {
-        matchCount++;
-        if (num_returns_per_match == 1) {
-          returnvec.emplace_back(double(j));
-          break;
-        } else {
-          resultvec.emplace_back(double(j));
+      return !(num_returns_per_match > 1 && matchCount >= num_returns_per_match);
+    };
+    // The index can only be used if the scan wouldn't get to an invalid entry
+    const std::vector<size_t> *rows = (column && !ft.empty()) ? column->findFirstChar(ft.get_utf8_char()) : nullptr;
+    if (column && (column->first_chars_end == searchTableSize ||
+                   (rows && num_returns_per_match > 0 && rows->size() >= num_returns_per_match))) {
+      if (rows) {
+        for (size_t j : *rows) {
+          if (!add_match(j)) break;
+        }
+      }
+    } else {
+      for (size_t j = 0; j < searchTableSize; ++j) {
+        const auto& entryVec = table[j].toVector();
+        if (entryVec.size() <= index_col_num) {
+          LOG(message_group::Warning, loc, session->documentRoot(), "Invalid entry in search vector at index %1$d, required number of values in the entry: %2$d. Invalid entry: %3$s", j, (index_col_num + 1), table[j].toEchoStringNoThrow());
+          return {session};
         }
-        if (num_returns_per_match > 1 && matchCount >= num_returns_per_match) {
-          break;
+        if (!ft.empty() && ft.get_utf8_char() == entryVec[index_col_num].toStrUtf8Wrapper().get_utf8_char()) {
+          if (!add_match(j)) break;
         }
       }
     }
@@ -619,24 +667,42 @@ Value builtin_search(Arguments arguments, const Location& loc)
 
   VectorType returnvec(arguments.session());
 
+  // Number and string values can be found in the table's index
+  const auto& table = searchTable.toVector();
+  const auto *column = (searchTable.type() == Value::Type::VECTOR && VectorIndex::worthIndexing(table.size()))
+    ? table.index().column(table, index_col_num) : nullptr;
+  auto is_indexed = [&](const Value& value) {
+    return column && (value.type() == Value::Type::NUMBER || value.type() == Value::Type::STRING);
+  };
+
   if (findThis.type() == Value::Type::NUMBER) {
     unsigned int matchCount = 0;
-    size_t j = 0;
-    for (const auto& search_element : searchTable.toVector()) {
-      if ((index_col_num == 0 && (findThis == search_element).toBool()) ||
-          (index_col_num < search_element.toVector().size() &&
-           (findThis == search_element.toVector()[index_col_num]).toBool())) {
-        returnvec.emplace_back(double(j));
-        matchCount++;
-        if (num_returns_per_match != 0 && matchCount >= num_returns_per_match) break;
+    if (is_indexed(findThis)) {
+      if (const auto *rows = column->find(findThis)) {
+        for (size_t j : *rows) {
+          returnvec.emplace_back(double(j));
+          matchCount++;
+          if (num_returns_per_match != 0 && matchCount >= num_returns_per_match) break;
+        }
+      }
+    } else {
+      size_t j = 0;
+      for (const auto& search_element : table) {
+        if ((index_col_num == 0 && (findThis == search_element).toBool()) ||
+            (index_col_num < search_element.toVector().size() &&
+             (findThis == search_element.toVector()[index_col_num]).toBool())) {
+          returnvec.emplace_back(double(j));
+          matchCount++;
+          if (num_returns_per_match != 0 && matchCount >= num_returns_per_match) break;
+        }
+        ++j;
       }
-      ++j;
     }
   } else if (findThis.type() == Value::Type::STRING) {
     if (searchTable.type() == Value::Type::STRING) {
       returnvec = search(findThis.toStrUtf8Wrapper(), searchTable.toStrUtf8Wrapper(), num_returns_per_match, arguments.session());
     } else {
-      returnvec = search(findThis.toStrUtf8Wrapper(), searchTable.toVector(), num_returns_per_match, index_col_num, loc, arguments.session());
+      returnvec = search(findThis.toStrUtf8Wrapper(), searchTable.toVector(), num_returns_per_match, index_col_num, column, loc, arguments.session());
     }
   } else if (findThis.type() == Value::Type::VECTOR) {
     const auto& findVec = findThis.toVector();
@@ -644,21 +710,33 @@ Value builtin_search(Arguments arguments, const Location& loc)
       unsigned int matchCount = 0;
       VectorType resultvec(arguments.session());
 
-      size_t j = 0;
-      for (const auto& search_element : searchTable.toVector()) {
-        if ((index_col_num == 0 && (find_value == search_element).toBool()) ||
-            (index_col_num < search_element.toVector().size() &&
-             (find_value == search_element.toVector()[index_col_num]).toBool())) {
-          matchCount++;
-          if (num_returns_per_match == 1) {
-            returnvec.emplace_back(double(j));
-            break;
-          } else {
-            resultvec.emplace_back(double(j));
+      // Returns false when no more matches are needed
+      auto add_match = [&](size_t j) {
+        matchCount++;
+        if (num_returns_per_match == 1) {
+          returnvec.emplace_back(double(j));
+          return false;
+        } else {
+          resultvec.emplace_back(double(j));
+        }
+        return !(num_returns_per_match > 1 && matchCount >= num_returns_per_match);
+      };
+      if (is_indexed(find_value)) {
+        if (const auto *rows = column->find(find_value)) {
+          for (size_t j : *rows) {
+            if (!add_match(j)) break;
           }
-          if (num_returns_per_match > 1 && matchCount >= num_returns_per_match) break;
         }
-        ++j;
+      } else {
+        size_t j = 0;
+        for (const auto& search_element : table) {
+          if ((index_col_num == 0 && (find_value == search_element).toBool()) ||
+              (index_col_num < search_element.toVector().size() &&
+               (find_value == search_element.toVector()[index_col_num]).toBool())) {
+            if (!add_match(j)) break;
+          }
+          ++j;
+        }
       }
       if ((num_returns_per_match == 1 && matchCount == 0) ||
           num_returns_per_match == 0 ||
@@ -707,6 +785,7 @@ Value builtin_parent_module(Arguments arguments, const Location& loc)
     d = arguments[0]->toDouble();
   }
 
+  arguments.session()->record_impure_operation();
   int n = trunc(d);
   int s = UserModule::stack_size();
   if (n < 0) {
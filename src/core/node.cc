@@ -35,7 +35,10 @@
 #include <functional>
 #include <iostream>
 #include <algorithm>
+#include <iterator>
+#include <sstream>
 #include <string>
+#include <boost/regex.hpp>
 
 size_t AbstractNode::idx_counter;
 
@@ -50,6 +53,16 @@ std::string AbstractNode::toString() const
   return this->name() + "()";
 }
 
+std::string AbstractNode::idString() const
+{
+  static const boost::regex re(R"([^\s\"]+|\"(?:[^\"\\]|\\.)*\")");
+  const auto name = this->toString();
+  std::ostringstream stream;
+  boost::sregex_token_iterator it(name.begin(), name.end(), re, 0);
+  std::copy(it, boost::sregex_token_iterator(), std::ostream_iterator<std::string>(stream));
+  return stream.str();
+}
+
 std::shared_ptr<const AbstractNode> AbstractNode::getNodeByID(int idx, std::deque<std::shared_ptr<const AbstractNode>>& path) const
 {
   auto self = shared_from_this();
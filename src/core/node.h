@@ -25,6 +25,9 @@ void progress_report_fin();
    tree.  Both the module tree and the node tree are regenerated from
    scratch for each compile.
 
+   With memoized module instantiation (see ModuleInstanceCache), a node can
+   have several parents, so visitors must not assume a node is visited once.
+
  */
 class AbstractNode : public BaseVisitable, public std::enable_shared_from_this<AbstractNode>
 {
@@ -37,6 +40,9 @@ public:
   VISITABLE();
   AbstractNode(const ModuleInstantiation *mi);
   virtual std::string toString() const;
+  /*! Identifies the node in cache keys, see Tree::getIdString(). Defaults to
+      toString() without whitespace outside of string literals. */
+  virtual std::string idString() const;
   /*! The 'OpenSCAD name' of this node, defaults to classname, but can be
       overloaded to provide specialization for e.g. CSG nodes, primitive nodes etc.
       Used for human-readable output. */
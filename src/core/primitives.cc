@@ -25,6 +25,7 @@
  */
 
 #include "core/primitives.h"
+#include "Cache.h"
 #include "geometry/Geometry.h"
 #include "geometry/linalg.h"
 #include "core/Builtins.h"
@@ -34,6 +35,7 @@
 #include "geometry/PolySet.h"
 #include "geometry/Polygon2d.h"
 #include "utils/calc.h"
+#include "utils/hash.h"
 #include "core/node.h"
 #include "utils/degree_trig.h"
 #include "core/module.h"
@@ -46,6 +48,7 @@
 #include <cmath>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -54,11 +57,84 @@ using namespace boost::assign; // bring 'operator+=()' into scope
 
 #define F_MINIMUM 0.01
 
-template <class InsertIterator>
-static void generate_circle(InsertIterator iter, double r, double z, int fragments) {
+/*
+   The trigonometry of circular primitives only depends on the number of
+   fragments, so it's cached and repeated spheres, cylinders and circles don't
+   recompute it. Instances are created by scaling the unit tables, using the same
+   arithmetic as computing each vertex directly, so the vertices are identical.
+ */
+namespace {
+
+// Don't keep tables for huge $fn around
+constexpr int MAX_CACHED_FRAGMENTS = 4096;
+// Memory used by each cache, the least recently used tables are dropped first
+constexpr size_t UNIT_TABLE_CACHE_SIZE = 2ul * 1024ul * 1024ul;
+
+// cos/sin of the angle of each fragment of a circle, or
+// sin/cos of the polar angle of each ring of a sphere
+using UnitTable = VectorOfVector2d;
+using UnitTableCache = Cache<int, std::shared_ptr<const UnitTable>>;
+
+std::shared_ptr<const UnitTable> create_unit_circle(int fragments)
+{
+  auto circle = std::make_shared<UnitTable>(fragments);
   for (int i = 0; i < fragments; ++i) {
     double phi = (360.0 * i) / fragments;
-    *(iter++) = {r * cos_degrees(phi), r * sin_degrees(phi), z};
+    (*circle)[i] = {cos_degrees(phi), sin_degrees(phi)};
+  }
+  return circle;
+}
+
+std::shared_ptr<const UnitTable> create_sphere_rings(int num_fragments)
+{
+  auto rings = std::make_shared<UnitTable>();
+  size_t num_rings = (num_fragments + 1) / 2;
+  // Uncomment the following three lines to enable experimental sphere
+  // tessellation
+  //  if (num_rings % 2 == 0) num_rings++; // To ensure that the middle ring is at
+  //  phi == 0 degrees
+
+  // double offset = 0.5 * ((fragments / 2) % 2);
+  rings->reserve(num_rings);
+  for (int i = 0; i < num_rings; ++i) {
+    //                double phi = (180.0 * (i + offset)) / (fragments/2);
+    const double phi = (180.0 * (i + 0.5)) / num_rings;
+    rings->emplace_back(sin_degrees(phi), cos_degrees(phi));
+  }
+  return rings;
+}
+
+std::shared_ptr<const UnitTable> get_cached(UnitTableCache& cache, std::mutex& mutex,
+                                            int fragments, std::shared_ptr<const UnitTable> (*create)(int))
+{
+  if (fragments > MAX_CACHED_FRAGMENTS) return create(fragments);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (const auto *table = cache[fragments]) return *table;
+  auto table = create(fragments);
+  cache.insert(fragments, new std::shared_ptr<const UnitTable>(table), sizeof(UnitTable) + table->size() * sizeof(Vector2d));
+  return table;
+}
+
+std::shared_ptr<const UnitTable> unit_circle(int fragments)
+{
+  static std::mutex mutex;
+  static UnitTableCache cache(UNIT_TABLE_CACHE_SIZE);
+  return get_cached(cache, mutex, fragments, create_unit_circle);
+}
+
+std::shared_ptr<const UnitTable> sphere_rings(int fragments)
+{
+  static std::mutex mutex;
+  static UnitTableCache cache(UNIT_TABLE_CACHE_SIZE);
+  return get_cached(cache, mutex, fragments, create_sphere_rings);
+}
+
+} // namespace
+
+template <class InsertIterator>
+static void generate_circle(InsertIterator iter, double r, double z, const UnitTable& circle) {
+  for (const auto& v : circle) {
+    *(iter++) = {r * v[0], r * v[1], z};
   }
 }
 
@@ -191,23 +267,18 @@ std::unique_ptr<const Geometry> SphereNode::createGeometry() const
   }
 
   auto num_fragments = Calc::get_fragments_from_r(r, fn, fs, fa);
-  size_t num_rings = (num_fragments + 1) / 2;
-  // Uncomment the following three lines to enable experimental sphere
-  // tessellation
-  //  if (num_rings % 2 == 0) num_rings++; // To ensure that the middle ring is at
-  //  phi == 0 degrees
+  const auto circle = unit_circle(num_fragments);
+  const auto rings = sphere_rings(num_fragments);
+  const int num_rings = rings->size();
 
   auto polyset = std::make_unique<PolySet>(3, /*convex*/true);
   polyset->vertices.reserve(num_rings * num_fragments);
-
-  // double offset = 0.5 * ((fragments / 2) % 2);
-  for (int i = 0; i < num_rings; ++i) {
-    //                double phi = (180.0 * (i + offset)) / (fragments/2);
-    const double phi = (180.0 * (i + 0.5)) / num_rings;
-    const double radius = r * sin_degrees(phi);
-    generate_circle(std::back_inserter(polyset->vertices), radius, r * cos_degrees(phi), num_fragments);
+  for (const auto& ring : *rings) {
+    const double radius = r * ring[0];
+    generate_circle(std::back_inserter(polyset->vertices), radius, r * ring[1], *circle);
   }
 
+  polyset->indices.reserve((num_rings - 1) * num_fragments + 2);
   polyset->indices.push_back({});
   for (int i = 0; i < num_fragments; ++i) {
     polyset->indices.back().push_back(i);
@@ -277,6 +348,7 @@ std::unique_ptr<const Geometry> CylinderNode::createGeometry() const
 
   bool cone = (r2 == 0.0);
   bool inverted_cone = (r1 == 0.0);
+  const auto circle = unit_circle(num_fragments);
 
   auto polyset = std::make_unique<PolySet>(3, /*convex*/true);
   polyset->vertices.reserve((cone || inverted_cone) ? num_fragments + 1 : 2 * num_fragments);
@@ -284,12 +356,12 @@ std::unique_ptr<const Geometry> CylinderNode::createGeometry() const
   if (inverted_cone) {
     polyset->vertices.emplace_back(0.0, 0.0, z1);
   } else {
-   generate_circle(std::back_inserter(polyset->vertices), r1, z1, num_fragments);
+   generate_circle(std::back_inserter(polyset->vertices), r1, z1, *circle);
   }
   if (cone) {
     polyset->vertices.emplace_back(0.0, 0.0, z2);
   } else {
-    generate_circle(std::back_inserter(polyset->vertices), r2, z2, num_fragments);
+    generate_circle(std::back_inserter(polyset->vertices), r2, z2, *circle);
   }
 
   for (int i = 0; i < num_fragments; ++i) {
@@ -404,18 +476,33 @@ std::string PolyhedronNode::toString() const
   return stream.str();
 }
 
+// Hashes the points and faces instead of printing them, which dominates
+// building the cache keys of large polyhedrons.
+std::string PolyhedronNode::idString() const
+{
+  ContentHash content;
+  content.add(this->points.size());
+  content.addCoordinates(reinterpret_cast<const double *>(this->points.data()), this->points.size() * 3);
+  for (const auto& face : this->faces) {
+    content.add(face.size());
+    content.add(face.data(), face.size() * sizeof(face[0]));
+  }
+  std::ostringstream stream;
+  stream << "polyhedron(points=" << this->points.size() << ",faces=" << this->faces.size()
+         << ",content=" << content.hex() << ",convexity=" << this->convexity << ")";
+  return stream.str();
+}
+
 std::unique_ptr<const Geometry> PolyhedronNode::createGeometry() const
 {
   auto p = PolySet::createEmpty();
   p->setConvexity(this->convexity);
-  p->vertices=this->points;
-  p->indices=this->faces;
+  p->vertices = this->points;
+  p->indices.reserve(this->faces.size());
   bool is_triangular = true;
-  for (auto &poly : p->indices) {
-    std::reverse(poly.begin(),poly.end());
-    if (is_triangular && poly.size() > 3) {
-      is_triangular = false;
-    }
+  for (const auto& face : this->faces) {
+    p->indices.emplace_back(face.rbegin(), face.rend());
+    if (face.size() > 3) is_triangular = false;
   }
   p->setTriangular(is_triangular);
   return p;
@@ -464,6 +551,7 @@ static std::shared_ptr<AbstractNode> builtin_polyhedron(const ModuleInstantiatio
     } else {
       size_t pointIndexIndex = 0;
       IndexedFace face;
+      face.reserve(faceValue.toVector().size());
       for (const Value& pointIndexValue : faceValue.toVector()) {
         if (pointIndexValue.type() != Value::Type::NUMBER) {
           LOG(message_group::Error, inst->location(), parameters.documentRoot(), "Unable to convert faces[%1$d][%2$d] = %3$s to a number", faceIndex, pointIndexIndex, pointIndexValue.toEchoStringNoThrow());
@@ -548,11 +636,11 @@ std::unique_ptr<const Geometry> CircleNode::createGeometry() const
   }
 
   auto fragments = Calc::get_fragments_from_r(this->r, this->fn, this->fs, this->fa);
+  const auto circle = unit_circle(fragments);
   Outline2d o;
   o.vertices.resize(fragments);
   for (int i = 0; i < fragments; ++i) {
-    double phi = (360.0 * i) / fragments;
-    o.vertices[i] = {this->r * cos_degrees(phi), this->r * sin_degrees(phi)};
+    o.vertices[i] = this->r * (*circle)[i];
   }
   return std::make_unique<Polygon2d>(o);
 }
@@ -621,26 +709,45 @@ std::string PolygonNode::toString() const
   return stream.str();
 }
 
+std::string PolygonNode::idString() const
+{
+  ContentHash content;
+  content.add(this->points.size());
+  content.addCoordinates(reinterpret_cast<const double *>(this->points.data()), this->points.size() * 2);
+  for (const auto& path : this->paths) {
+    content.add(path.size());
+    content.add(path.data(), path.size() * sizeof(path[0]));
+  }
+  std::ostringstream stream;
+  stream << "polygon(points=" << this->points.size();
+  if (this->paths.empty()) {
+    stream << ",paths=undef";
+  } else {
+    stream << ",paths=" << this->paths.size();
+  }
+  stream << ",content=" << content.hex() << ",convexity=" << this->convexity << ")";
+  return stream.str();
+}
+
 std::unique_ptr<const Geometry> PolygonNode::createGeometry() const
 {
   auto p = std::make_unique<Polygon2d>();
   if (this->paths.empty() && this->points.size() > 2) {
     Outline2d outline;
-    for (const auto& point : this->points) {
-      outline.vertices.push_back(point);
-    }
-    p->addOutline(outline);
+    outline.vertices.assign(this->points.begin(), this->points.end());
+    p->addOutline(std::move(outline));
   } else {
     bool positive = true; // First outline is positive
     for (const auto& path : this->paths) {
       Outline2d outline;
+      outline.vertices.reserve(path.size());
       for (const auto& index : path) {
         assert(index < this->points.size());
         const auto& point = points[index];
         outline.vertices.push_back(point);
       }
       outline.positive = positive;
-      p->addOutline(outline);
+      p->addOutline(std::move(outline));
       positive = false; // Subsequent outlines are holes
     }
   }
@@ -660,6 +767,7 @@ static std::shared_ptr<AbstractNode> builtin_polygon(const ModuleInstantiation *
     LOG(message_group::Error, inst->location(), parameters.documentRoot(), "Unable to convert points = %1$s to a vector of coordinates", parameters["points"].toEchoStringNoThrow());
     return node;
   }
+  node->points.reserve(parameters["points"].toVector().size());
   for (const Value& pointValue : parameters["points"].toVector()) {
     Vector2d point;
     if (!pointValue.getVec2(point[0], point[1]) ||
@@ -674,12 +782,14 @@ static std::shared_ptr<AbstractNode> builtin_polygon(const ModuleInstantiation *
 
   if (parameters["paths"].type() == Value::Type::VECTOR) {
     size_t pathIndex = 0;
+    node->paths.reserve(parameters["paths"].toVector().size());
     for (const Value& pathValue : parameters["paths"].toVector()) {
       if (pathValue.type() != Value::Type::VECTOR) {
         LOG(message_group::Error, inst->location(), parameters.documentRoot(), "Unable to convert paths[%1$d] = %2$s to a vector of numbers", pathIndex, pathValue.toEchoStringNoThrow());
       } else {
         size_t pointIndexIndex = 0;
         std::vector<size_t> path;
+        path.reserve(pathValue.toVector().size());
         for (const Value& pointIndexValue : pathValue.toVector()) {
           if (pointIndexValue.type() != Value::Type::NUMBER) {
             LOG(message_group::Error, inst->location(), parameters.documentRoot(), "Unable to convert paths[%1$d][%2$d] = %3$s to a number", pathIndex, pointIndexIndex, pointIndexValue.toEchoStringNoThrow());
@@ -0,0 +1,45 @@
+#include "core/str_utf8_wrapper.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+#include <glib.h>
+
+const std::shared_ptr<str_utf8_wrapper::str_utf8_t>& str_utf8_wrapper::ascii_char(char c)
+{
+  static const auto chars = []() {
+    std::array<std::shared_ptr<str_utf8_t>, 0x80> chars;
+    for (size_t i = 0; i < chars.size(); ++i) {
+      const char ch = static_cast<char>(i);
+      chars[i] = std::make_shared<str_utf8_t>(&ch, 1, 1);
+    }
+    return chars;
+  }();
+  return chars[static_cast<unsigned char>(c)];
+}
+
+const char *str_utf8_wrapper::char_pointer(size_t idx) const
+{
+  const char *str = this->c_str();
+  // Every code point is a single byte
+  if (this->get_utf8_strlen() == this->size()) return str + idx;
+
+  // Steps through the string like g_utf8_strlen(), which counted its code points
+  std::call_once(str_ptr->offsets_built, [this, str]() {
+    auto& offsets = str_ptr->offsets;
+    offsets.reserve(this->get_utf8_strlen() / OFFSET_STRIDE + 1);
+    const char *end = str + this->size();
+    size_t i = 0;
+    for (const char *p = str; p < end && *p; p = g_utf8_next_char(p), ++i) {
+      if (i % OFFSET_STRIDE == 0) offsets.push_back(p - str);
+    }
+  });
+
+  const auto& offsets = str_ptr->offsets;
+  if (idx / OFFSET_STRIDE >= offsets.size()) return g_utf8_offset_to_pointer(str, idx);
+  const char *ptr = str + offsets[idx / OFFSET_STRIDE];
+  for (size_t i = idx % OFFSET_STRIDE; i > 0; --i) ptr = g_utf8_next_char(ptr);
+  return ptr;
+}
@@ -1,14 +1,20 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <iterator>
 #include <utility>
 #include <cstdint>
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <glib.h>
 
+class StringIndex;
+
 class str_utf8_wrapper
 {
 private:
@@ -24,8 +30,22 @@ private:
     str_utf8_t(const char *cstr, size_t size, size_t u8len) : u8str(cstr, size), u8len(u8len) {
     }
     const std::string u8str;
-    size_t u8len = LENGTH_UNKNOWN;
+    // Computed on demand, possibly by several threads, see ParallelEvaluation
+    std::atomic<size_t> u8len{LENGTH_UNKNOWN};
+    std::shared_ptr<StringIndex> index; // built on demand, see StringIndex
+    // Byte offsets of every OFFSET_STRIDE-th code point, built when a non-ASCII string is first indexed
+    std::once_flag offsets_built;
+    std::vector<size_t> offsets;
   };
+  static constexpr size_t OFFSET_STRIDE = 16;
+  // Shared objects for single ASCII characters, as created by iterating or indexing strings
+  static const std::shared_ptr<str_utf8_t>& ascii_char(char c);
+  static std::shared_ptr<str_utf8_t> make_char(const char *cstr, size_t clen) {
+    if (clen == 1 && static_cast<unsigned char>(*cstr) < 0x80) return ascii_char(*cstr);
+    return std::make_shared<str_utf8_t>(cstr, clen, 1);
+  }
+  // Pointer to the code point at index idx, which must be less than get_utf8_strlen()
+  [[nodiscard]] const char *char_pointer(size_t idx) const;
   // private constructor for copying members
   explicit str_utf8_wrapper(const std::shared_ptr<str_utf8_t>& str_in) : str_ptr(str_in) { }
 
@@ -60,7 +80,7 @@ private:
   str_utf8_wrapper(const std::string& s) : str_ptr(std::make_shared<str_utf8_t>(s)) { }
   str_utf8_wrapper(const char *cstr) : str_ptr(std::make_shared<str_utf8_t>(cstr)) { }
   // for enumerating single utf8 chars from iterator
-  str_utf8_wrapper(const char *cstr, size_t clen) : str_ptr(std::make_shared<str_utf8_t>(cstr, clen, 1)) { }
+  str_utf8_wrapper(const char *cstr, size_t clen) : str_ptr(make_char(cstr, clen)) { }
   str_utf8_wrapper(uint32_t unicode) {
     char out[6] = " ";
     if (unicode != 0 && g_unichar_validate(unicode)) {
@@ -86,31 +106,31 @@ private:
   [[nodiscard]] const std::string& toString() const { return this->str_ptr->u8str; }
   [[nodiscard]] size_t size() const { return this->str_ptr->u8str.size(); }
   str_utf8_wrapper operator[](const size_t idx) const {
-    if (idx < this->size()) {
-      // Ensure character (not byte) index is inside the character/glyph array
-      if (idx < this->get_utf8_strlen()) {
-        gchar utf8_of_cp[6] = ""; //A buffer for a single unicode character to be copied into
-	auto ptr = g_utf8_offset_to_pointer(str_ptr->u8str.c_str(), idx);
-	if (ptr) {
-          g_utf8_strncpy(utf8_of_cp, ptr, 1);
-        }
-        return std::string(utf8_of_cp);
-      }
+    // Ensure character (not byte) index is inside the character/glyph array
+    if (idx < this->size() && idx < this->get_utf8_strlen()) {
+      const char *ptr = char_pointer(idx);
+      const char *end = this->c_str() + this->size();
+      if (*ptr) return {ptr, static_cast<size_t>(std::min<const char *>(g_utf8_next_char(ptr), end) - ptr)};
     }
     return {};
   }
 
   [[nodiscard]] size_t get_utf8_strlen() const {
-    if (str_ptr->u8len == str_utf8_t::LENGTH_UNKNOWN) {
-      str_ptr->u8len = g_utf8_strlen(str_ptr->u8str.c_str(), static_cast<gssize>(str_ptr->u8str.size()));
+    size_t len = str_ptr->u8len.load(std::memory_order_relaxed);
+    if (len == str_utf8_t::LENGTH_UNKNOWN) {
+      len = g_utf8_strlen(str_ptr->u8str.c_str(), static_cast<gssize>(str_ptr->u8str.size()));
+      str_ptr->u8len.store(len, std::memory_order_relaxed);
     }
-    return str_ptr->u8len;
+    return len;
   }
 
   [[nodiscard]] uint32_t get_utf8_char() const {
     return g_utf8_get_char(str_ptr->u8str.c_str());
   }
 
+  // Search index shared by all copies of this string
+  [[nodiscard]] StringIndex& index() const;
+
   [[nodiscard]] bool utf8_validate() const {
     return g_utf8_validate(str_ptr->u8str.c_str(), -1, nullptr);
   }
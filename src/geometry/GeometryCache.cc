@@ -23,7 +23,13 @@ std::shared_ptr<const Geometry> GeometryCache::get(const std::string& id) const
 
 bool GeometryCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& geom)
 {
-  auto inserted = this->cache.insert(id, new cache_entry(geom), geom ? geom->memsize() : 0);
+  auto entry = new cache_entry(geom);
+  auto inserted = this->cache.insert(id, entry, geom ? geom->memsize() : 0);
+  if (inserted && geom) {
+    entry->index = &this->index;
+    entry->key = this->cache.key(id);
+    this->index[geom.get()] = entry->key;
+  }
 #if defined(ENABLE_CGAL) && defined(DEBUG)
   assert(!dynamic_cast<const CGAL_Nef_polyhedron *>(geom.get()));
   if (inserted) PRINTDB("Geometry Cache insert: %s (%d bytes)",
@@ -34,6 +40,23 @@ bool GeometryCache::insert(const std::string& id, const std::shared_ptr<const Ge
   return inserted;
 }
 
+const GeometryCache::cache_entry *GeometryCache::findEntry(const Geometry& geom) const
+{
+  auto it = this->index.find(&geom);
+  if (it == this->index.end()) return nullptr;
+  return this->cache[*it->second];
+}
+
+bool GeometryCache::insertConversion(const Geometry& source, const std::shared_ptr<const Geometry>& converted)
+{
+  auto it = this->index.find(&source);
+  if (it == this->index.end()) return false;
+  const std::string& id = *it->second;
+  auto entry = this->cache[id];
+  entry->conversions.push_back(converted);
+  return this->cache.setCost(id, entry->cost());
+}
+
 size_t GeometryCache::size() const
 {
   return cache.size();
@@ -65,3 +88,18 @@ GeometryCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& g
 {
   if (print_messages_stack.size() > 0) this->msg = print_messages_stack.back();
 }
+
+GeometryCache::cache_entry::~cache_entry()
+{
+  if (!index) return;
+  // The same geometry may have been cached again under another key
+  auto it = index->find(geom.get());
+  if (it != index->end() && it->second == key) index->erase(it);
+}
+
+size_t GeometryCache::cache_entry::cost() const
+{
+  size_t cost = geom ? geom->memsize() : 0;
+  for (const auto& converted : conversions) cost += converted->memsize();
+  return cost;
+}
@@ -3,6 +3,8 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "Cache.h"
 #include "geometry/Geometry.h"
@@ -24,14 +26,50 @@ public:
   void clear() { cache.clear(); }
   void print();
 
+  // Representations of cached geometries converted for another backend, e.g. the Nef polyhedron
+  // or Manifold of a cached PolySet. They add to the cost of the source's cache entry and
+  // are evicted together with it.
+  template <typename T>
+  std::shared_ptr<const T> getConversion(const Geometry& source) const {
+    if (const auto *entry = findEntry(source)) {
+      for (const auto& converted : entry->conversions) {
+        if (auto result = std::dynamic_pointer_cast<const T>(converted)) return result;
+      }
+    }
+    return nullptr;
+  }
+  bool insertConversion(const Geometry& source, const std::shared_ptr<const Geometry>& converted);
+
+  /*!
+     Returns converter(), reusing an earlier conversion of source to T if source is cached.
+   */
+  template <typename T, typename Convert>
+  std::shared_ptr<const T> convert(const std::shared_ptr<const Geometry>& source, const Convert& converter) {
+    if (auto result = getConversion<T>(*source)) return result;
+    std::shared_ptr<const T> result = converter();
+    if (result) insertConversion(*source, result);
+    return result;
+  }
+
 private:
   static GeometryCache *inst;
 
   struct cache_entry {
     std::shared_ptr<const class Geometry> geom;
+    std::vector<std::shared_ptr<const Geometry>> conversions;
     std::string msg;
+    // Owning cache's index of entries by geometry, and this entry's key in it
+    std::unordered_map<const Geometry *, const std::string *> *index{nullptr};
+    const std::string *key{nullptr};
     cache_entry(const std::shared_ptr<const Geometry>& geom);
+    cache_entry(const cache_entry&) = delete;
+    cache_entry& operator=(const cache_entry&) = delete;
+    ~cache_entry();
+    [[nodiscard]] size_t cost() const;
   };
+  const cache_entry *findEntry(const Geometry& geom) const;
 
+  // Key of the cache entry holding each geometry, for looking up its conversions
+  std::unordered_map<const Geometry *, const std::string *> index;
   Cache<std::string, cache_entry> cache;
 };
@@ -29,6 +29,7 @@
 #include "io/DxfData.h"
 #include "glview/RenderSettings.h"
 #include "utils/degree_trig.h"
+#include "utils/parallel.h"
 #include <cmath>
 #include <iterator>
 #include <cassert>
@@ -36,6 +37,8 @@
 #include <utility>
 #include <memory>
 #include <algorithm>
+#include <numeric>
+#include <unordered_map>
 #include "utils/boost-utils.h"
 #include "geometry/boolean_utils.h"
 #ifdef ENABLE_CGAL
@@ -123,9 +126,81 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren(const Abstrac
   return {};
 }
 
+/*!
+   Returns true if the bounding boxes are strictly apart along some axis,
+   so the geometries inside them can neither overlap nor touch.
+ */
+static bool boundingBoxesApart(const BoundingBox& a, const BoundingBox& b)
+{
+  for (int i = 0; i < 3; ++i) {
+    if (a.max()[i] < b.min()[i] || b.max()[i] < a.min()[i]) return true;
+  }
+  return false;
+}
+
+/*!
+   Partitions non-empty children into clusters connected by overlapping (or touching)
+   bounding boxes, sweeping along X. Children keep their relative order within a cluster.
+ */
+static std::vector<Geometry::Geometries> clusterOverlappingChildren(const Geometry::Geometries& children)
+{
+  std::vector<const Geometry::GeometryItem *> items;
+  std::vector<BoundingBox> bboxes;
+  for (const auto& item : children) {
+    items.push_back(&item);
+    bboxes.push_back(item.second->getBoundingBox());
+  }
+  std::vector<size_t> parent(items.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&](size_t i) {
+    while (parent[i] != i) i = parent[i] = parent[parent[i]];
+    return i;
+  };
+
+  std::vector<size_t> order(items.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return bboxes[a].min().x() < bboxes[b].min().x(); });
+  for (size_t i = 0; i < order.size(); ++i) {
+    const auto& bbox = bboxes[order[i]];
+    for (size_t j = i + 1; j < order.size() && bboxes[order[j]].min().x() <= bbox.max().x(); ++j) {
+      if (!boundingBoxesApart(bbox, bboxes[order[j]])) parent[find(order[i])] = find(order[j]);
+    }
+  }
+
+  std::vector<Geometry::Geometries> clusters;
+  std::vector<int> cluster_index(items.size(), -1);
+  for (size_t i = 0; i < items.size(); ++i) {
+    auto& idx = cluster_index[find(i)];
+    if (idx < 0) {
+      idx = clusters.size();
+      clusters.emplace_back();
+    }
+    clusters[idx].push_back(*items[i]);
+  }
+  return clusters;
+}
+
+#ifdef ENABLE_CGAL
+/*!
+   Unions the children with CGAL, using corefinement if selected and all children are
+   closed manifold volumes, Nef polyhedra otherwise.
+ */
+static std::shared_ptr<const Geometry> applyUnion3DCGAL(Geometry::Geometries::iterator chbegin, Geometry::Geometries::iterator chend)
+{
+  if (RenderSettings::inst()->backend3D == RenderBackend3D::CGALCorefinementBackend) {
+    if (auto result = CGALUtils::applyUnion3DCorefined(chbegin, chend)) return result;
+  }
+  return CGALUtils::applyUnion3D(chbegin, chend);
+}
+#endif
+
 /*!
    Applies the operator to all child nodes of the given node.
 
+   With the bounding-box-shortcuts feature, unions of disjoint clusters, differences
+   with subtrahends apart from the first child and intersections of children without
+   a common point are resolved from bounding boxes where possible.
+
    May return nullptr or any 3D Geometry object
  */
 GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren3D(const AbstractNode& node, OpenSCADOperator op)
@@ -170,7 +245,23 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren3D(const Abstr
     }
 #endif
 #ifdef ENABLE_CGAL
-    return ResultObject::constResult(std::shared_ptr<const Geometry>(CGALUtils::applyUnion3D(actualchildren.begin(), actualchildren.end())));
+    if (Feature::ExperimentalBoundingBoxShortcuts.is_enabled()) {
+      // Nef unions of disjoint parts are expensive, so only union clusters of overlapping
+      // children and concatenate the clusters. Manifold already does this internally.
+      auto clusters = clusterOverlappingChildren(actualchildren);
+      if (clusters.size() > 1) {
+        PolySetBuilder builder;
+        for (auto& cluster : clusters) {
+          if (cluster.size() == 1) {
+            builder.appendGeometry(cluster.front().second);
+          } else if (auto N = applyUnion3DCGAL(cluster.begin(), cluster.end())) {
+            builder.appendGeometry(N);
+          }
+        }
+        return ResultObject::mutableResult(std::shared_ptr<Geometry>(builder.build()));
+      }
+    }
+    return ResultObject::constResult(applyUnion3DCGAL(actualchildren.begin(), actualchildren.end()));
 #else
     assert(false && "No boolean backend available");
 #endif
@@ -178,12 +269,45 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren3D(const Abstr
   }
   default:
   {
+    // With shortcuts enabled, bounding boxes can tell the result without running the
+    // boolean kernel: Subtrahends apart from the first child don't change it, and
+    // children whose bounding boxes have no common point don't intersect.
+    if (Feature::ExperimentalBoundingBoxShortcuts.is_enabled()) {
+      const auto& first = children.front().second;
+      if (first && !first->isEmpty() && op == OpenSCADOperator::DIFFERENCE) {
+        const auto bbox = first->getBoundingBox();
+        Geometry::Geometries actualchildren{children.front()};
+        for (auto it = std::next(children.begin()); it != children.end(); ++it) {
+          if (it->second && !it->second->isEmpty() && !boundingBoxesApart(bbox, it->second->getBoundingBox())) {
+            actualchildren.push_back(*it);
+          } else if (it->first) {
+            it->first->progress_report();
+          }
+        }
+        if (actualchildren.size() == 1) return ResultObject::constResult(first);
+        children = std::move(actualchildren);
+      } else if (op == OpenSCADOperator::INTERSECTION) {
+        BoundingBox common;
+        bool all_nonempty = true;
+        for (const auto& item : children) {
+          all_nonempty = item.second && !item.second->isEmpty();
+          if (!all_nonempty) break;
+          const auto bbox = item.second->getBoundingBox();
+          common = &item == &children.front() ? bbox : common.intersection(bbox);
+        }
+        if (all_nonempty && common.isEmpty()) return {};
+      }
+    }
+
 #ifdef ENABLE_MANIFOLD
     if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
       return ResultObject::mutableResult(ManifoldUtils::applyOperator3DManifold(children, op));
     }
 #endif
 #ifdef ENABLE_CGAL
+    if (RenderSettings::inst()->backend3D == RenderBackend3D::CGALCorefinementBackend) {
+      if (auto result = CGALUtils::applyOperator3DCorefined(children, op)) return ResultObject::constResult(result);
+    }
     return ResultObject::constResult(CGALUtils::applyOperator3D(children, op));
 #else
     assert(false && "No boolean backend available");
@@ -785,22 +909,12 @@ Response GeometryEvaluator::visit(State& state, const LinearExtrudeNode& node)
   return Response::ContinueTraversal;
 }
 
-static void fill_ring(std::vector<Vector3d>& ring, const Outline2d& o, double a, bool flip)
+/*!
+   Computes the position of a profile vertex revolved to an angle with the given cosine and sine.
+ */
+static Vector3d revolve_vertex(const Vector2d& v, double cos_a, double sin_a)
 {
-  if (flip) {
-    unsigned int l = o.vertices.size() - 1;
-    for (unsigned int i = 0; i < o.vertices.size(); ++i) {
-      ring[i][0] = o.vertices[l - i][0] * cos_degrees(a);
-      ring[i][1] = o.vertices[l - i][0] * sin_degrees(a);
-      ring[i][2] = o.vertices[l - i][1];
-    }
-  } else {
-    for (unsigned int i = 0; i < o.vertices.size(); ++i) {
-      ring[i][0] = o.vertices[i][0] * cos_degrees(a);
-      ring[i][1] = o.vertices[i][0] * sin_degrees(a);
-      ring[i][2] = o.vertices[i][1];
-    }
-  }
+  return {v[0] * cos_a, v[0] * sin_a, v[1]};
 }
 
 /*!
@@ -825,9 +939,6 @@ static std::unique_ptr<Geometry> rotatePolygon(const RotateExtrudeNode& node, co
 {
   if (node.angle == 0) return nullptr;
 
-  PolySetBuilder builder;
-  builder.setConvexity(node.convexity);
-
   double min_x = 0;
   double max_x = 0;
   unsigned int fragments = 0;
@@ -847,58 +958,120 @@ static std::unique_ptr<Geometry> rotatePolygon(const RotateExtrudeNode& node, co
 
   bool flip_faces = (min_x >= 0 && node.angle > 0) || (min_x < 0 && node.angle < 0);
 
-  // If not going all the way around, we have to create faces on each end.
-  if (node.angle != 360) {
-    auto ps_start = poly.tessellate(); // starting face
-    Transform3d rotx(angle_axis_degrees(90, Vector3d::UnitX()));
-    Transform3d rotz1(angle_axis_degrees(node.start, Vector3d::UnitZ()));
-    ps_start->transform(rotz1 * rotx);
-    // Flip vertex ordering
-    if (!flip_faces) {
-      for (auto& p : ps_start->indices) {
-        std::reverse(p.begin(), p.end());
-      }
+  // The ring topology is known up front, so the mesh is indexed directly rather than
+  // deduplicating the vertices of every triangle by value: Each ring lists the distinct profile
+  // vertices, so vertices shared between outlines are welded once here. Each outline refers to
+  // them in ring order, reversed when flipping faces, with consecutive duplicates removed so no
+  // zero-area faces are emitted. Vertices on the rotation axis coincide in all rings and are
+  // stored once, ahead of the rings. A full revolution closes by reusing the first ring.
+  std::vector<Vector2d> profile;
+  std::unordered_map<Vector3d, size_t> profile_index;
+  std::vector<std::vector<size_t>> outlines;
+  for (const auto& o : poly.outlines()) {
+    std::vector<size_t> outline;
+    outline.reserve(o.vertices.size());
+    auto add_vertex = [&](const Vector2d& v) {
+      const auto [it, inserted] = profile_index.emplace(Vector3d(v[0], v[1], 0), profile.size());
+      if (inserted) profile.push_back(v);
+      if (outline.empty() || outline.back() != it->second) outline.push_back(it->second);
+    };
+    if (flip_faces) std::for_each(o.vertices.rbegin(), o.vertices.rend(), add_vertex);
+    else std::for_each(o.vertices.begin(), o.vertices.end(), add_vertex);
+    if (outline.size() > 1 && outline.back() == outline.front()) outline.pop_back();
+    if (outline.size() >= 3) outlines.push_back(std::move(outline));
+  }
+  auto on_axis = [&](size_t p) { return profile[p][0] == 0; };
+  std::vector<int> ring0_index(profile.size());
+  int num_axis = 0;
+  for (size_t p = 0; p < profile.size(); ++p) {
+    if (on_axis(p)) ring0_index[p] = num_axis++;
+  }
+  const size_t ring_stride = profile.size() - num_axis;
+  int next_index = num_axis;
+  for (size_t p = 0; p < profile.size(); ++p) {
+    if (!on_axis(p)) ring0_index[p] = next_index++;
+  }
+  const bool closed = node.angle == 360;
+  const size_t num_rings = closed ? fragments : fragments + 1;
+  auto vertex_index = [&](size_t ring, size_t p) -> int {
+    return on_axis(p) ? ring0_index[p] : ring0_index[p] + ring * ring_stride;
+  };
+  auto ring_angle = [&](size_t ring) {
+    return ring == 0 ? node.start : node.start + ring * node.angle / fragments; // start on the X axis
+  };
+
+  auto ps = std::make_unique<PolySet>(3);
+  ps->setConvexity(node.convexity);
+  ps->setTriangular(true);
+  ps->vertices.resize(num_axis + num_rings * ring_stride);
+  parallelizable_for(0, num_rings, [&](size_t ring) {
+    const double a = ring_angle(ring);
+    const double cos_a = cos_degrees(a);
+    const double sin_a = sin_degrees(a);
+    for (size_t p = 0; p < profile.size(); ++p) {
+      if (ring == 0 || !on_axis(p)) ps->vertices[vertex_index(ring, p)] = revolve_vertex(profile[p], cos_a, sin_a);
     }
-    builder.appendPolySet(*ps_start);
+  });
 
-    auto ps_end = poly.tessellate();
-    Transform3d rotz2(angle_axis_degrees(node.start + node.angle, Vector3d::UnitZ()));
-    ps_end->transform(rotz2 * rotx);
-    if (flip_faces) {
+  // If not going all the way around, we have to create faces on each end.
+  // The tessellated end faces are mapped back onto the first and last ring,
+  // dropping triangles which collapse onto welded vertices.
+  if (!closed) {
+    auto add_end_face = [&](size_t ring, bool reverse) {
+      const double a = ring_angle(ring);
+      auto ps_end = poly.tessellate();
+      std::vector<int> end_index(ps_end->vertices.size());
+      for (size_t i = 0; i < ps_end->vertices.size(); ++i) {
+        const auto& v = ps_end->vertices[i];
+        auto it = profile_index.find(v);
+        if (it != profile_index.end()) {
+          end_index[i] = vertex_index(ring, it->second);
+        } else { // vertex inserted by the tessellator
+          end_index[i] = ps->vertices.size();
+          ps->vertices.push_back(revolve_vertex({v[0], v[1]}, cos_degrees(a), sin_degrees(a)));
+        }
+      }
       for (auto& p : ps_end->indices) {
-        std::reverse(p.begin(), p.end());
+        if (reverse) std::reverse(p.begin(), p.end());
+        for (auto& idx : p) idx = end_index[idx];
+        if (p[0] == p[1] || p[1] == p[2] || p[2] == p[0]) continue;
+        ps->indices.push_back(std::move(p));
       }
-    }
-    builder.appendPolySet(*ps_end);
+    };
+    add_end_face(0, !flip_faces); // starting face
+    add_end_face(fragments, flip_faces);
   }
 
-  for (const auto& o : poly.outlines()) {
-    std::vector<Vector3d> rings[2];
-    rings[0].resize(o.vertices.size());
-    rings[1].resize(o.vertices.size());
-
-    fill_ring(rings[0], o, node.start, flip_faces); // first ring
-    for (unsigned int j = 0; j < fragments; ++j) {
-      double a = node.start + (j + 1) * node.angle / fragments; // start on the X axis
-      fill_ring(rings[(j + 1) % 2], o, a, flip_faces);
-
-      for (size_t i = 0; i < o.vertices.size(); ++i) {
-        builder.appendPolygon({
-                rings[j % 2][(i + 1) % o.vertices.size()],
-                rings[(j + 1) % 2][(i + 1) % o.vertices.size()],
-                rings[j % 2][i]
-        });
-
-        builder.appendPolygon({
-                rings[(j + 1) % 2][(i + 1) % o.vertices.size()],
-                rings[(j + 1) % 2][i],
-                rings[j % 2][i]
-        });
-      }
+  // Each quad between two consecutive rings is split into two triangles,
+  // except that a triangle collapses where it touches the rotation axis.
+  size_t fragment_triangles = 0;
+  for (const auto& outline : outlines) {
+    for (size_t i = 0; i < outline.size(); ++i) {
+      const size_t next = outline[(i + 1) % outline.size()];
+      fragment_triangles += !on_axis(next) + !on_axis(outline[i]);
     }
   }
+  const size_t sides_begin = ps->indices.size();
+  ps->indices.resize(sides_begin + fragments * fragment_triangles);
+  parallelizable_for(0, fragments, [&](size_t j) {
+    const size_t ring1 = j;
+    const size_t ring2 = (j + 1) % num_rings;
+    auto face = ps->indices.begin() + sides_begin + j * fragment_triangles;
+    for (const auto& outline : outlines) {
+      for (size_t i = 0; i < outline.size(); ++i) {
+        const size_t p = outline[i];
+        const size_t next = outline[(i + 1) % outline.size()];
+        if (!on_axis(next)) {
+          *(face++) = {vertex_index(ring1, next), vertex_index(ring2, next), vertex_index(ring1, p)};
+        }
+        if (!on_axis(p)) {
+          *(face++) = {vertex_index(ring2, next), vertex_index(ring2, p), vertex_index(ring1, p)};
+        }
+      }
+    }
+  });
 
-  return builder.build();
+  return ps;
 }
 
 /*!
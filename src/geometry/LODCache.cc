@@ -0,0 +1,104 @@
+#include "geometry/LODCache.h"
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "geometry/PolySet.h"
+#include "geometry/PolySetUtils.h"
+
+LODCache::~LODCache()
+{
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+    jobs_.clear();
+  }
+  cv_.notify_one();
+  // Waits for the level being computed, if any
+  if (worker_.joinable()) worker_.join();
+}
+
+std::shared_ptr<const PolySet> LODCache::get(const std::shared_ptr<const PolySet>& ps, int level)
+{
+  std::lock_guard lock(mutex_);
+  auto it = entries_.find(ps.get());
+  if (it != entries_.end() && it->second.ps.lock() != ps) {
+    // The address was reused by a new PolySet
+    entries_.erase(it);
+    it = entries_.end();
+  }
+  if (it == entries_.end()) {
+    purge();
+    it = entries_.emplace(ps.get(), Entry{ps, {}, {}, {}}).first;
+  }
+  Entry& entry = it->second;
+  if (entry.unreduced[level]) return ps;
+  if (entry.levels[level]) return entry.levels[level];
+  if (!entry.pending[level]) {
+    entry.pending[level] = true;
+    jobs_.emplace_back(ps, level);
+    if (!worker_.joinable()) worker_ = std::thread([this]() { run(); });
+    cv_.notify_one();
+  }
+  return nullptr;
+}
+
+void LODCache::clear()
+{
+  std::lock_guard lock(mutex_);
+  jobs_.clear();
+  entries_.clear();
+}
+
+void LODCache::addReadyHandler(const void *owner, ReadyHandler handler)
+{
+  std::lock_guard lock(mutex_);
+  ready_handlers_[owner] = std::move(handler);
+}
+
+void LODCache::removeReadyHandler(const void *owner)
+{
+  std::lock_guard lock(mutex_);
+  ready_handlers_.erase(owner);
+}
+
+// Drop entries whose PolySet is gone. Must be called with mutex_ held.
+void LODCache::purge()
+{
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.ps.expired()) it = entries_.erase(it);
+    else ++it;
+  }
+}
+
+void LODCache::run()
+{
+  while (true) {
+    Job job;
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+      if (stopping_) return;
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    const auto& [ps, level] = job;
+    std::shared_ptr<const PolySet> result = PolySetUtils::decimate(*ps, resolution(level));
+    // Not worth a separate mesh unless it is much smaller
+    const bool unreduced = result->indices.size() * 4 > ps->indices.size() * 3;
+    {
+      std::lock_guard lock(mutex_);
+      const auto it = entries_.find(ps.get());
+      if (it != entries_.end() && it->second.ps.lock() == ps) {
+        if (unreduced) it->second.unreduced[level] = true;
+        else it->second.levels[level] = std::move(result);
+        it->second.pending[level] = false;
+      }
+      generation_++;
+      // Called with the lock held, so removed handlers are never called afterwards
+      for (const auto& [owner, handler] : ready_handlers_) handler();
+    }
+  }
+}
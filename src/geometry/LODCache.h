@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+class PolySet;
+
+/*!
+   Simplified versions of PolySets for drawing objects that cover few pixels.
+
+   Levels are computed by PolySetUtils::decimate() on a background thread and
+   kept for as long as the source PolySet is alive. Level 0 is the coarsest.
+   Views register a ready handler to repaint once a missing level is done.
+ */
+class LODCache
+{
+public:
+  // Destroyed at exit, which stops the worker thread
+  static LODCache *instance() { static LODCache cache; return &cache; }
+  ~LODCache();
+  LODCache(const LODCache&) = delete;
+  LODCache& operator=(const LODCache&) = delete;
+
+  static constexpr int NUM_LEVELS = 6;
+  // PolySets with fewer faces are always drawn at full resolution
+  static constexpr size_t MIN_FACES = 4096;
+  // Number of grid cells along the largest extent of the bounding box at the given level
+  static constexpr int resolution(int level) { return 16 << level; }
+
+  // Return ps simplified to level, or nullptr if that level is still being computed.
+  // Returns ps itself if simplification wouldn't reduce it significantly.
+  std::shared_ptr<const PolySet> get(const std::shared_ptr<const PolySet>& ps, int level);
+  // Incremented whenever a level finishes computing
+  [[nodiscard]] unsigned int generation() const { return generation_; }
+  void clear();
+
+  using ReadyHandler = std::function<void()>;
+  // Call handler from the worker thread whenever a level finishes computing,
+  // until removed. Handlers must not block or call back into the cache.
+  void addReadyHandler(const void *owner, ReadyHandler handler);
+  void removeReadyHandler(const void *owner);
+
+private:
+  LODCache() = default;
+
+  struct Entry {
+    std::weak_ptr<const PolySet> ps;
+    std::array<std::shared_ptr<const PolySet>, NUM_LEVELS> levels;
+    std::array<bool, NUM_LEVELS> pending{};
+    // Levels which wouldn't reduce ps significantly, so ps itself is drawn.
+    // Kept as a flag, since a reference to ps would keep the entry alive.
+    std::array<bool, NUM_LEVELS> unreduced{};
+  };
+  using Job = std::pair<std::shared_ptr<const PolySet>, int>;
+
+  void run();
+  void purge();
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Job> jobs_;
+  std::unordered_map<const PolySet *, Entry> entries_;
+  std::unordered_map<const void *, ReadyHandler> ready_handlers_;
+  std::thread worker_;
+  bool stopping_{false};
+  std::atomic<unsigned int> generation_{0};
+};
@@ -202,11 +202,15 @@ void PolySetBuilder::appendPolySet(const PolySet& ps)
     color_indices_.resize(color_indices_.size() + ps.indices.size(), -1);
   }
 
+  // Look up each referenced vertex once rather than once per polygon corner,
+  // in order of first use so unreferenced vertices are not added.
+  std::vector<int> vertex_map(ps.vertices.size(), -1);
   reserve(numVertices() + ps.vertices.size(), numPolygons() + ps.indices.size());
   for (const auto& poly : ps.indices) {
     beginPolygon(poly.size());
     for (const auto& ind: poly) {
-      addVertex(ps.vertices[ind]);
+      if (vertex_map[ind] < 0) vertex_map[ind] = vertexIndex(ps.vertices[ind]);
+      addVertex(vertex_map[ind]);
     }
     endPolygon();
   }
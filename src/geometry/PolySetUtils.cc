@@ -1,12 +1,19 @@
 #include "geometry/PolySetUtils.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <memory>
 #include <cstddef>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include <Eigen/SVD>
+#include <boost/functional/hash.hpp>
+
 #include <boost/range/adaptor/reversed.hpp>
 
 #include "geometry/Geometry.h"
@@ -16,6 +23,7 @@
 #include "geometry/Polygon2d.h"
 #include "utils/printutils.h"
 #include "geometry/GeometryUtils.h"
+#include "utils/hash.h"
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/cgalutils.h"
 #endif
@@ -227,4 +235,96 @@ std::string polySetToPolyhedronSource(const PolySet& ps)
   return sstr.str();
 }
 
+/*!
+   Simplifies a 3D PolySet by vertex clustering: the bounding box is divided
+   into cubic cells, resolution cells along its largest extent, and all
+   vertices within a cell are merged. Each merged vertex is placed where it
+   minimizes the quadric error of the planes of its incident triangles, or at
+   the mean of its vertices if that position is ill-defined.
+   Triangles collapsing to a line or point are dropped. The result is meant for
+   drawing only; it is not guaranteed to be manifold.
+ */
+std::unique_ptr<PolySet> decimate(const PolySet& ps, int resolution)
+{
+  std::unique_ptr<PolySet> triangulated;
+  if (!ps.isTriangular()) triangulated = tessellate_faces(ps);
+  const PolySet& input = triangulated ? *triangulated : ps;
+
+  auto result = std::make_unique<PolySet>(3);
+  result->setConvexity(ps.getConvexity());
+  result->setTriangular(true);
+  const BoundingBox bbox = input.getBoundingBox();
+  if (bbox.isEmpty() || resolution <= 0) return result;
+  const double cell_size = bbox.sizes().maxCoeff() / resolution;
+  if (cell_size <= 0) return result;
+
+  struct Cluster {
+    Eigen::Matrix3d A = Eigen::Matrix3d::Zero();
+    Vector3d b = Vector3d::Zero();
+    Vector3d sum = Vector3d::Zero();
+    int count = 0;
+    int index = -1;
+  };
+  std::vector<Cluster> clusters;
+  std::unordered_map<Vector3l, int> cell_clusters;
+  std::vector<int> vertex_clusters(input.vertices.size());
+  for (size_t i = 0; i < input.vertices.size(); ++i) {
+    const Vector3d& v = input.vertices[i];
+    const Vector3l cell = ((v - bbox.min()) / cell_size).array().floor().cast<int64_t>();
+    const auto [it, inserted] = cell_clusters.emplace(cell, clusters.size());
+    if (inserted) clusters.emplace_back();
+    vertex_clusters[i] = it->second;
+    clusters[it->second].sum += v;
+    clusters[it->second].count++;
+  }
+
+  // Area weighted plane quadrics: Q(x) = x'Ax - 2b'x + c
+  for (const auto& face : input.indices) {
+    const Vector3d& p0 = input.vertices[face[0]];
+    const Vector3d n = (input.vertices[face[1]] - p0).cross(input.vertices[face[2]] - p0);
+    const double area2 = n.norm();
+    if (area2 == 0) continue;
+    const Vector3d unit = n / area2;
+    const Eigen::Matrix3d A = (area2 / 2) * unit * unit.transpose();
+    const Vector3d b = A * p0;
+    for (const auto idx : face) {
+      clusters[vertex_clusters[idx]].A += A;
+      clusters[vertex_clusters[idx]].b += b;
+    }
+  }
+
+  std::unordered_set<std::array<int, 3>, boost::hash<std::array<int, 3>>> faces;
+  const auto has_colors = !input.color_indices.empty();
+  if (has_colors) result->colors = input.colors;
+  for (size_t i = 0; i < input.indices.size(); ++i) {
+    const auto& face = input.indices[i];
+    std::array<int, 3> tri = {vertex_clusters[face[0]], vertex_clusters[face[1]], vertex_clusters[face[2]]};
+    if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0]) continue;
+    // Rotate the smallest index first, keeping the orientation, to find duplicates
+    std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+    if (!faces.insert(tri).second) continue;
+
+    auto& out = result->indices.emplace_back();
+    for (const auto c : tri) {
+      auto& cluster = clusters[c];
+      if (cluster.index < 0) {
+        cluster.index = result->vertices.size();
+        const Vector3d mean = cluster.sum / cluster.count;
+        // Solve A x = b around the mean, ignoring directions the planes don't constrain
+        Eigen::JacobiSVD<Eigen::Matrix3d> svd(cluster.A, Eigen::ComputeFullU | Eigen::ComputeFullV);
+        svd.setThreshold(1e-3);
+        Vector3d x = mean + svd.solve(cluster.b - cluster.A * mean);
+        const Vector3d cell_min = bbox.min() + ((mean - bbox.min()) / cell_size).array().floor().matrix() * cell_size;
+        const BoundingBox cell(cell_min - Vector3d::Constant(cell_size / 2),
+                               cell_min + Vector3d::Constant(cell_size * 1.5));
+        if (!x.allFinite() || !cell.contains(x)) x = mean;
+        result->vertices.push_back(x);
+      }
+      out.push_back(cluster.index);
+    }
+    if (has_colors) result->color_indices.push_back(input.color_indices[i]);
+  }
+  return result;
+}
+
 } // namespace PolySetUtils
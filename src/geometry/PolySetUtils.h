@@ -18,4 +18,6 @@ std::shared_ptr<const PolySet> getGeometryAsPolySet(const std::shared_ptr<const
 
 std::string polySetToPolyhedronSource(const PolySet& ps);
 
+std::unique_ptr<PolySet> decimate(const PolySet& ps, int resolution);
+
 }
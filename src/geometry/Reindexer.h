@@ -1,19 +1,67 @@
 #pragma once
 
 #include <cstddef>
-#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
 #include <vector>
 #include <algorithm>
+#include "geometry/linalg.h"
 #include "utils/hash.h" // IWYU pragma: keep
 
+/*!
+   Hash used by Reindexer. Defaults to std::hash, with a cheaper coordinate hash
+   for Eigen vectors than the generic boost::hash_combine based one.
+ */
+template <typename T>
+struct ReindexerHash {
+  std::size_t operator()(const T& val) const { return std::hash<T>()(val); }
+};
+
+template <typename Scalar, int N, int Options>
+struct ReindexerHash<Eigen::Matrix<Scalar, N, 1, Options, N, 1>> {
+  std::size_t operator()(const Eigen::Matrix<Scalar, N, 1, Options, N, 1>& val) const {
+    uint64_t h = 0;
+    for (int i = 0; i < N; ++i) {
+      h = (h ^ bits(val[i])) * 0x9e3779b97f4a7c15ull;
+      h ^= h >> 32;
+    }
+    h *= 0xbf58476d1ce4e5b9ull;
+    return h ^ (h >> 31);
+  }
+
+private:
+  static uint64_t bits(Scalar s) {
+    if constexpr (std::is_floating_point_v<Scalar>) {
+      s += Scalar(0); // -0 == 0, so they must hash the same
+      if constexpr (sizeof(Scalar) == sizeof(uint32_t)) {
+        uint32_t b;
+        std::memcpy(&b, &s, sizeof(b));
+        return b;
+      } else {
+        uint64_t b;
+        std::memcpy(&b, &s, sizeof(b));
+        return b;
+      }
+    } else {
+      return static_cast<uint64_t>(s);
+    }
+  }
+};
+
 /*!
    Reindexes a collection of elements of type T.
    Typically used to compress an element array by creating and reusing indexes to
    a new array or to merge two index tables to two arrays into a common index.
    The latter is necessary for VBO's or for unifying texture coordinate indices to
    multiple texture coordinate arrays.
+
+   Elements are stored in insertion order and looked up through a flat open addressing
+   table (linear probing) holding the element index together with part of its hash.
  */
-template <typename T>
+template <typename T, typename Hash = ReindexerHash<T>>
 class Reindexer
 {
 public:
@@ -21,48 +69,83 @@ public:
      Looks up a value. Will insert the value if it doesn't already exist.
      Returns the new index. */
   int lookup(const T& val) {
-    auto iter = this->map.find(val);
-    if (iter != this->map.end()) return iter->second;
-    else {
-      this->map.insert(std::make_pair(val, this->map.size()));
-      return this->map.size() - 1;
+    if ((this->vec.size() + 1) * 2 > this->slots.size()) rehash(std::max<std::size_t>(16, this->slots.size() * 2));
+    const uint64_t h = Hash()(val);
+    const auto tag = static_cast<uint32_t>(h >> 32);
+    const std::size_t mask = this->slots.size() - 1;
+    for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+      auto& slot = this->slots[i];
+      if (slot.index < 0) {
+        slot = {tag, static_cast<int>(this->vec.size())};
+        this->vec.push_back(val);
+        return slot.index;
+      }
+      if (slot.tag == tag && this->vec[slot.index] == val) return slot.index;
+    }
+  }
+
+  /*!
+     Looks up a range of values, inserting the ones which don't already exist.
+     Writes the index of each value to out and returns the end of the output range.
+   */
+  template <class InputIterator, class OutputIterator>
+  OutputIterator lookup(InputIterator begin, InputIterator end, OutputIterator out) {
+    using Category = typename std::iterator_traits<InputIterator>::iterator_category;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+      reserve(size() + std::distance(begin, end));
     }
+    for (; begin != end; ++begin) *(out++) = lookup(*begin);
+    return out;
   }
 
   /*!
      Returns the current size of the new element array
    */
   [[nodiscard]] std::size_t size() const {
-    return this->map.size();
+    return this->vec.size();
   }
 
   /*!
      Reserve the requested size for the new element map
    */
   void reserve(std::size_t n) {
-    return this->map.reserve(n);
+    this->vec.reserve(n);
+    std::size_t capacity = 16;
+    while (capacity < n * 2) capacity *= 2;
+    if (capacity > this->slots.size()) rehash(capacity);
   }
 
   /*!
-     Return a copy of the new element array
+     Return the new element array
    */
-  const std::vector<T>& getArray() {
-    this->vec.resize(this->map.size());
-    for (const auto& entry : map) {
-      this->vec[entry.second] = entry.first;
-    }
+  const std::vector<T>& getArray() const {
     return this->vec;
   }
 
   /*!
      Copies the internal vector to the given destination
    */
-  template <class OutputIterator> void copy(OutputIterator dest) {
-    this->getArray();
+  template <class OutputIterator> void copy(OutputIterator dest) const {
     std::copy(this->vec.begin(), this->vec.end(), dest);
   }
 
 private:
-  std::unordered_map<T, int> map;
+  struct Slot {
+    uint32_t tag;
+    int index; // -1 for empty slots
+  };
+
+  void rehash(std::size_t capacity) {
+    this->slots.assign(capacity, Slot{0, -1});
+    const std::size_t mask = capacity - 1;
+    for (std::size_t idx = 0; idx < this->vec.size(); ++idx) {
+      const uint64_t h = Hash()(this->vec[idx]);
+      std::size_t i = h & mask;
+      while (this->slots[i].index >= 0) i = (i + 1) & mask;
+      this->slots[i] = {static_cast<uint32_t>(h >> 32), static_cast<int>(idx)};
+    }
+  }
+
+  std::vector<Slot> slots;
   std::vector<T> vec;
 };
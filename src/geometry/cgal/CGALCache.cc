@@ -3,6 +3,8 @@
 #include <cassert>
 #include <memory>
 #include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
 
 #include "geometry/Geometry.h"
@@ -16,7 +18,7 @@
 
 CGALCache *CGALCache::inst = nullptr;
 
-CGALCache::CGALCache(size_t limit) : cache(limit)
+CGALCache::CGALCache(size_t limit) : cache(limit), meshes(limit)
 {
 }
 
@@ -44,6 +46,7 @@ bool CGALCache::insert(const std::string& id, const std::shared_ptr<const Geomet
 {
   assert(acceptsGeometry(N));
   auto inserted = this->cache.insert(id, new cache_entry(N), N ? N->memsize() : 0);
+  trimMeshes();
 #ifdef DEBUG
   if (inserted) LOG("CGAL Cache insert: %1$s (%2$d bytes)", id.substr(0, 40), (N ? N->memsize() : 0));
   else LOG("CGAL Cache insert failed: %1$s (%2$d bytes)", id.substr(0, 40), (N ? N->memsize() : 0));
@@ -58,7 +61,14 @@ size_t CGALCache::size() const
 
 size_t CGALCache::totalCost() const
 {
-  return cache.totalCost();
+  return cache.totalCost() + meshes.totalCost();
+}
+
+// Geometries are preferred over meshes, which are cheaper to recreate
+void CGALCache::trimMeshes()
+{
+  const size_t used = this->cache.totalCost();
+  this->meshes.setMaxCost(used < this->cache.maxCost() ? this->cache.maxCost() - used : 0);
 }
 
 size_t CGALCache::maxSizeMB() const
@@ -69,17 +79,46 @@ size_t CGALCache::maxSizeMB() const
 void CGALCache::setMaxSizeMB(size_t limit)
 {
   this->cache.setMaxCost(limit * 1024ul * 1024ul);
+  trimMeshes();
 }
 
 void CGALCache::clear()
 {
   cache.clear();
+  meshes.clear();
+  mesh_inserts_since_purge = 0;
 }
 
 void CGALCache::print()
 {
   LOG("CGAL Polyhedrons in cache: %1$d", this->cache.size());
   LOG("CGAL cache size in bytes: %1$d", this->cache.totalCost());
+  if (this->meshes.size() > 0) {
+    LOG("CGAL meshes in cache: %1$d", this->meshes.size());
+    LOG("CGAL mesh cache size in bytes: %1$d", this->meshes.totalCost());
+  }
+}
+
+std::optional<std::shared_ptr<const CGAL_ExactMesh>> CGALCache::getMesh(const std::shared_ptr<const Geometry>& geom) const
+{
+  const auto *entry = this->meshes[geom.get()];
+  // The address may have been reused by another geometry
+  if (!entry || entry->geom.lock() != geom) return {};
+  return entry->mesh;
+}
+
+bool CGALCache::insertMesh(const std::shared_ptr<const Geometry>& geom, const std::shared_ptr<const CGAL_ExactMesh>& mesh)
+{
+  // Rough estimate; exact coordinates are mostly small rationals converted from doubles
+  const size_t cost = sizeof(mesh_entry) + (mesh ? mesh->number_of_vertices() * (sizeof(CGAL_Point_3) + 3 * 64) +
+                                           mesh->number_of_halfedges() * 4 * sizeof(uint32_t) +
+                                           mesh->number_of_faces() * sizeof(uint32_t) : 0);
+  if (++this->mesh_inserts_since_purge > this->meshes.size()) {
+    this->meshes.removeIf([](const mesh_entry& entry) { return entry.geom.expired(); });
+    this->mesh_inserts_since_purge = 0;
+  }
+  trimMeshes();
+  return this->meshes.insert(geom.get(), new mesh_entry{geom, mesh}, cost);
 }
 
 CGALCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& N)
@@ -3,8 +3,10 @@
 #include "Cache.h"
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <string>
 #include "geometry/Geometry.h"
+#include "geometry/cgal/cgal.h"
 
 class CGALCache
 {
@@ -24,6 +26,14 @@ public:
   void clear();
   void print();
 
+  // Exact triangle meshes of geometries used as corefinement operands, so each geometry is
+  // converted and validated only once. A null mesh marks a geometry which isn't a closed
+  // manifold volume. Entries don't keep their geometry alive, are ignored once it's gone and
+  // purged after as many inserts as there are entries, so purging is amortized over inserts.
+  // Meshes share the cache limit, using what geometries leave free.
+  std::optional<std::shared_ptr<const CGAL_ExactMesh>> getMesh(const std::shared_ptr<const Geometry>& geom) const;
+  bool insertMesh(const std::shared_ptr<const Geometry>& geom, const std::shared_ptr<const CGAL_ExactMesh>& mesh);
+
 private:
   static CGALCache *inst;
 
@@ -33,5 +43,14 @@ private:
     cache_entry(const std::shared_ptr<const Geometry>& N);
   };
 
+  struct mesh_entry {
+    std::weak_ptr<const Geometry> geom;
+    std::shared_ptr<const CGAL_ExactMesh> mesh;
+  };
+
+  void trimMeshes();
+
   Cache<std::string, cache_entry> cache;
+  Cache<const Geometry *, mesh_entry> meshes;
+  size_t mesh_inserts_since_purge = 0;
 };
@@ -69,4 +69,7 @@ using CGAL_DoubleKernel = CGAL::Cartesian<double>;
 using CGAL_DoublePoint3 = CGAL_DoubleKernel::Point_3;
 using CGAL_DoubleMesh = CGAL::Surface_mesh<CGAL_DoublePoint3>;
 
+// Triangle mesh with exact coordinates, used for corefinement based boolean operations
+using CGAL_ExactMesh = CGAL::Surface_mesh<CGAL_Point_3>;
+
 #endif /* ENABLE_CGAL */
@@ -0,0 +1,207 @@
+// this file is split into many separate cgalutils* files
+// in order to workaround gcc 4.9.1 crashing on systems with only 2GB of RAM
+
+#ifdef ENABLE_CGAL
+
+#include "geometry/cgal/cgal.h"
+#include "geometry/cgal/cgalutils.h"
+#include "geometry/cgal/CGALCache.h"
+#include "geometry/Geometry.h"
+#include "geometry/PolySet.h"
+#include "geometry/PolySetUtils.h"
+#include "utils/printutils.h"
+#include "core/progress.h"
+#include "core/node.h"
+
+#include <CGAL/boost/graph/helpers.h>
+#include <CGAL/Polygon_mesh_processing/corefinement.h>
+#include <CGAL/Polygon_mesh_processing/orientation.h>
+#include <CGAL/Polygon_mesh_processing/self_intersections.h>
+#include <CGAL/Polygon_mesh_processing/triangulate_faces.h>
+
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace CGALUtils {
+
+namespace PMP = CGAL::Polygon_mesh_processing;
+
+template <class TriangleMesh>
+bool corefineAndComputeUnion(TriangleMesh& lhs, TriangleMesh& rhs, TriangleMesh& out)
+{
+  return PMP::corefine_and_compute_union(lhs, rhs, out);
+}
+
+template <class TriangleMesh>
+bool corefineAndComputeIntersection(TriangleMesh& lhs, TriangleMesh& rhs, TriangleMesh& out)
+{
+  return PMP::corefine_and_compute_intersection(lhs, rhs, out);
+}
+
+template <class TriangleMesh>
+bool corefineAndComputeDifference(TriangleMesh& lhs, TriangleMesh& rhs, TriangleMesh& out)
+{
+  return PMP::corefine_and_compute_difference(lhs, rhs, out);
+}
+
+template bool corefineAndComputeUnion(CGAL_ExactMesh& lhs, CGAL_ExactMesh& rhs, CGAL_ExactMesh& out);
+template bool corefineAndComputeIntersection(CGAL_ExactMesh& lhs, CGAL_ExactMesh& rhs, CGAL_ExactMesh& out);
+template bool corefineAndComputeDifference(CGAL_ExactMesh& lhs, CGAL_ExactMesh& rhs, CGAL_ExactMesh& out);
+
+namespace {
+
+/*!
+   Corefinement needs closed triangle meshes without self-intersections, bounding a volume.
+ */
+bool isCorefinementOperand(const CGAL_ExactMesh& mesh)
+{
+  return CGAL::is_triangle_mesh(mesh) && CGAL::is_closed(mesh) &&
+         !PMP::does_self_intersect(mesh) && PMP::does_bound_a_volume(mesh);
+}
+
+std::shared_ptr<const CGAL_ExactMesh> createMesh(const std::shared_ptr<const Geometry>& geom)
+{
+  auto mesh = std::make_shared<CGAL_ExactMesh>();
+  if (const auto N = std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
+    // Keep exact coordinates of Nef polyhedra, e.g. cached results of the Nef fallback
+    if (!N->p3 || !N->p3->is_simple()) return nullptr;
+    convertNefPolyhedronToTriangleMesh(*N->p3, *mesh);
+  } else if (const auto ps = PolySetUtils::getGeometryAsPolySet(geom)) {
+    createMeshFromPolySet(*ps, *mesh);
+    if (!CGAL::is_triangle_mesh(*mesh) && !PMP::triangulate_faces(*mesh)) return nullptr;
+  } else {
+    return nullptr;
+  }
+  if (!isCorefinementOperand(*mesh)) return nullptr;
+  return mesh;
+}
+
+/*!
+   Returns the exact mesh of a non-empty 3D geometry, or nullptr if the geometry can't take
+   part in corefinement.
+ */
+std::shared_ptr<const CGAL_ExactMesh> getMesh(const std::shared_ptr<const Geometry>& geom)
+{
+  if (auto cached = CGALCache::instance()->getMesh(geom)) return *cached;
+  auto mesh = createMesh(geom);
+  CGALCache::instance()->insertMesh(geom, mesh);
+  return mesh;
+}
+
+/*!
+   Rounds the result to a PolySet, keeping the exact mesh around for operations using the
+   result as an operand.
+ */
+std::shared_ptr<const Geometry> createResult(const std::shared_ptr<const CGAL_ExactMesh>& mesh)
+{
+  std::shared_ptr<const PolySet> ps = createPolySetFromMesh(*mesh);
+  CGALCache::instance()->insertMesh(ps, mesh);
+  return ps;
+}
+
+} // namespace
+
+/*!
+   Unions the children using corefinement of their exact meshes.
+   Returns nullptr if any child isn't a closed manifold volume, or the result wouldn't be
+   manifold, in which case the caller should fall back to applyUnion3D().
+ */
+std::shared_ptr<const Geometry> applyUnion3DCorefined(
+  Geometry::Geometries::iterator chbegin, Geometry::Geometries::iterator chend)
+{
+  using QueueItem = std::pair<std::shared_ptr<const CGAL_ExactMesh>, int>;
+  struct QueueItemGreater {
+    // stable sort for priority_queue by facets, then progress mark
+    bool operator()(const QueueItem& lhs, const QueueItem& rhs) const
+    {
+      size_t l = lhs.first->number_of_faces();
+      size_t r = rhs.first->number_of_faces();
+      return (l > r) || (l == r && lhs.second > rhs.second);
+    }
+  };
+  std::priority_queue<QueueItem, std::vector<QueueItem>, QueueItemGreater> q;
+
+  try {
+    std::shared_ptr<const Geometry> single;
+    for (auto it = chbegin; it != chend; ++it) {
+      const auto& chgeom = it->second;
+      if (!chgeom || chgeom->isEmpty()) continue;
+      auto mesh = getMesh(chgeom);
+      if (!mesh) return nullptr;
+      q.emplace(mesh, it->first ? it->first->progress_mark : -1);
+      single = chgeom;
+    }
+    if (q.empty()) return std::make_shared<PolySet>(3);
+    if (q.size() == 1) return single;
+
+    progress_tick();
+    while (q.size() > 1) {
+      // Corefinement modifies its operands, so work on copies
+      CGAL_ExactMesh lhs(*q.top().first);
+      q.pop();
+      CGAL_ExactMesh rhs(*q.top().first);
+      q.pop();
+      auto out = std::make_shared<CGAL_ExactMesh>();
+      if (!corefineAndComputeUnion(lhs, rhs, *out)) return nullptr;
+      q.emplace(out, -1);
+      progress_tick();
+    }
+    return createResult(q.top().first);
+  } catch (const std::exception& e) {
+    PRINTDB("CGAL corefinement union failed, using Nef polyhedra: %1$s", e.what());
+  }
+  return nullptr;
+}
+
+/*!
+   Applies an intersection or difference to the children using corefinement of their
+   exact meshes. Returns nullptr if the caller should fall back to applyOperator3D().
+ */
+std::shared_ptr<const Geometry> applyOperator3DCorefined(const Geometry::Geometries& children, OpenSCADOperator op)
+{
+  if (op != OpenSCADOperator::INTERSECTION && op != OpenSCADOperator::DIFFERENCE) return nullptr;
+  if (children.empty()) return nullptr;
+
+  try {
+    // Check all operands before doing any work, to fall back early
+    std::vector<std::pair<std::shared_ptr<const CGAL_ExactMesh>, std::shared_ptr<const AbstractNode>>> operands;
+    for (const auto& [chnode, chgeom] : children) {
+      if (!chgeom || chgeom->isEmpty()) {
+        // empty op <something> => empty, intersecting something with nothing results in nothing
+        if (operands.empty() || op == OpenSCADOperator::INTERSECTION) return std::make_shared<PolySet>(3);
+        continue;
+      }
+      auto mesh = getMesh(chgeom);
+      if (!mesh) return nullptr;
+      operands.emplace_back(mesh, chnode);
+    }
+    if (operands.size() == 1) return children.front().second;
+
+    auto result = operands.front().first;
+    for (auto it = std::next(operands.begin()); it != operands.end(); ++it) {
+      CGAL_ExactMesh lhs(*result);
+      CGAL_ExactMesh rhs(*it->first);
+      auto out = std::make_shared<CGAL_ExactMesh>();
+      const bool ok = op == OpenSCADOperator::INTERSECTION ?
+                      corefineAndComputeIntersection(lhs, rhs, *out) :
+                      corefineAndComputeDifference(lhs, rhs, *out);
+      if (!ok) return nullptr;
+      result = out;
+      if (it->second) it->second->progress_report();
+      if (result->is_empty()) return std::make_shared<PolySet>(3);
+    }
+    return createResult(result);
+  } catch (const std::exception& e) {
+    PRINTDB("CGAL corefinement failed, using Nef polyhedra: %1$s", e.what());
+  }
+  return nullptr;
+}
+
+} // namespace CGALUtils
+
+#endif // ENABLE_CGAL
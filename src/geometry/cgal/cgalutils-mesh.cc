@@ -45,6 +45,7 @@ bool createMeshFromPolySet(const PolySet& ps, TriangleMesh& mesh)
 }
 
 template bool createMeshFromPolySet(const PolySet& ps, CGAL_DoubleMesh& mesh);
+template bool createMeshFromPolySet(const PolySet& ps, CGAL_ExactMesh& mesh);
 
 
 template <class TriangleMesh>
@@ -69,6 +70,8 @@ std::unique_ptr<PolySet> createPolySetFromMesh(const TriangleMesh& mesh)
   return builder.build();
 }
 
+template std::unique_ptr<PolySet> createPolySetFromMesh(const CGAL_ExactMesh& mesh);
+
 template <class InputKernel, class OutputKernel>
 void copyMesh(
   const CGAL::Surface_mesh<CGAL::Point_3<InputKernel>>& input,
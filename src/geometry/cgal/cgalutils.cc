@@ -6,6 +6,7 @@
 #include "geometry/cgal/cgalutils.h"
 
 #include "geometry/Geometry.h"
+#include "geometry/GeometryCache.h"
 #include "geometry/linalg.h"
 #include "geometry/cgal/cgal.h"
 #include "geometry/PolySet.h"
@@ -243,19 +244,23 @@ bool is_approximately_convex(const PolySet& ps) {
 
 std::shared_ptr<const CGAL_Nef_polyhedron> getNefPolyhedronFromGeometry(const std::shared_ptr<const Geometry>& geom)
 {
-  if (auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
-    return std::shared_ptr<CGAL_Nef_polyhedron>(createNefPolyhedronFromPolySet(*ps));
-  } else if (auto poly2d = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
-    std::shared_ptr<PolySet> ps(poly2d->tessellate());
-    return std::shared_ptr<CGAL_Nef_polyhedron>(createNefPolyhedronFromPolySet(*ps));
-  } else if (auto nef = std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
+  if (auto nef = std::dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
     return nef;
+  }
+  // Cached geometries are often used in many booleans, so keep their Nef polyhedron around
+  return GeometryCache::instance()->convert<CGAL_Nef_polyhedron>(geom, [&]() -> std::shared_ptr<const CGAL_Nef_polyhedron> {
+    if (auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
+      return createNefPolyhedronFromPolySet(*ps);
+    } else if (auto poly2d = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
+      std::shared_ptr<PolySet> ps(poly2d->tessellate());
+      return createNefPolyhedronFromPolySet(*ps);
 #if ENABLE_MANIFOLD
-  } else if (auto mani = std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
-    return std::shared_ptr<CGAL_Nef_polyhedron>(createNefPolyhedronFromPolySet(*mani->toPolySet()));
+    } else if (auto mani = std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
+      return createNefPolyhedronFromPolySet(*mani->toPolySet());
 #endif
-  }
-  return nullptr;
+    }
+    return nullptr;
+  });
 }
 
 /*
@@ -22,6 +22,7 @@
 #include "geometry/PolySetUtils.h"
 #include "utils/calc.h"
 #include "utils/degree_trig.h"
+#include "utils/parallel.h"
 
 namespace {
 
@@ -282,8 +283,9 @@ std::unique_ptr<PolySet> assemblePolySetForCGAL(const Polygon2d& polyref,
    and their corresponding transformed points one step up: (prev2, curr2).
    Quads are triangulated across the shorter of the two diagonals, which works well in most cases.
    However, when diagonals are equal length, decision may flip depending on other factors.
+   Writes the 2 * slice_stride triangles of the slice to indices.
  */
-void add_slice_indices(PolygonIndices &indices, int slice_idx, int slice_stride, const Polygon2d& poly,
+void add_slice_indices(IndexedFace *indices, int slice_idx, int slice_stride, const Polygon2d& poly,
                               double rot1, double rot2,
                               const Vector2d& scale1, const Vector2d& scale2)
 {
@@ -325,27 +327,27 @@ void add_slice_indices(PolygonIndices &indices, int slice_idx, int slice_stride,
       // Split along shortest diagonal,
       // unless at top for a 0-scaled axis (which can create 0 thickness "ears")
       if (splitfirst xor any_zero) {
-        indices.push_back({
+        *(indices++) = {
           prev_slice + curr_idx,
           curr_slice + curr_idx,
           prev_slice + prev_idx,
-        });
-        indices.push_back({
+        };
+        *(indices++) = {
           curr_slice + prev_idx,
           prev_slice + prev_idx,
           curr_slice + curr_idx,
-        });
+        };
       } else {
-        indices.push_back({
+        *(indices++) = {
           prev_slice + curr_idx,
           curr_slice + prev_idx,
           prev_slice + prev_idx,
-        });
-        indices.push_back({
+        };
+        *(indices++) = {
           prev_slice + curr_idx,
           curr_slice + curr_idx,
           curr_slice + prev_idx,
-        });
+        };
       }
       prev1 = curr1;
       prev2 = curr2;
@@ -477,40 +479,42 @@ std::unique_ptr<Geometry> extrudePolygon(const LinearExtrudeNode& node, const Po
   for (const auto& o : polyref.outlines()) {
     slice_stride += o.vertices.size();
   }
-  std::vector<Vector3d> vertices;
-  vertices.reserve(slice_stride * (num_slices + 1));
+  // Slices are independent, so vertices and side indices are generated in parallel,
+  // each slice writing to its own range of the preallocated buffers.
+  std::vector<Vector3d> vertices(slice_stride * (num_slices + 1));
   PolygonIndices indices;
   indices.reserve(slice_stride * (num_slices + 1) * 2); // sides + endcaps
+  indices.resize(slice_stride * num_slices * 2);
 
   // Calculate all vertices
   Vector2d full_scale(1 - node.scale_x, 1 - node.scale_y);
   double full_rot = -node.twist;
   auto full_height = (h2 - h1);
-  for (unsigned int slice_idx = 0; slice_idx <= num_slices; slice_idx++) {
+  parallelizable_for(0, num_slices + 1, [&](size_t slice_idx) {
     Eigen::Affine2d trans(
       Eigen::Scaling(Vector2d(1,1) - full_scale * slice_idx / num_slices) *
       Eigen::Affine2d(rotate_degrees(full_rot * slice_idx / num_slices)));
 
+    auto vertex = vertices.begin() + slice_idx * slice_stride;
     for (const auto& o : polyref.outlines()) {
       for (const auto& v : o.vertices) {
         auto tmp = trans * v;
-        vertices.emplace_back(Vector3d(tmp[0], tmp[1], 0.0) + h1 + full_height * slice_idx / num_slices);
+        *(vertex++) = Vector3d(tmp[0], tmp[1], 0.0) + h1 + full_height * slice_idx / num_slices;
       }
     }
-  }
+  });
 
   // Create indices for sides
-  for (unsigned int slice_idx = 1; slice_idx <= num_slices; slice_idx++) {
+  parallelizable_for(1, num_slices + 1, [&](size_t slice_idx) {
     double rot_prev = node.twist * (slice_idx -1)/ num_slices;
     double rot_curr = node.twist * slice_idx / num_slices;
-    auto height_prev = h1 + (h2 - h1) * (slice_idx - 1) / num_slices;
-    auto height_curr = h1 + (h2 - h1) * slice_idx / num_slices;
     Vector2d scale_prev(1 - (1 - node.scale_x) * (slice_idx - 1) / num_slices,
                     1 - (1 - node.scale_y) * (slice_idx - 1) / num_slices);
     Vector2d scale_curr(1 - (1 - node.scale_x) * slice_idx / num_slices,
                     1 - (1 - node.scale_y) * slice_idx / num_slices);
-    add_slice_indices(indices, slice_idx, slice_stride, polyref, rot_prev, rot_curr, scale_prev, scale_curr);
-  }
+    add_slice_indices(&indices[(slice_idx - 1) * slice_stride * 2], slice_idx, slice_stride, polyref,
+                      rot_prev, rot_curr, scale_prev, scale_curr);
+  });
 
   // For Manifold, we can tesselate the endcaps using existing vertices to build a manifold mesh.
   // Without Manifold, however, we don't have such a tessellator available, so we'll have to build
@@ -40,11 +40,13 @@ ManifoldGeometry::ManifoldGeometry(
   manifold::Manifold mani,
   const std::set<uint32_t> & originalIDs,
   const std::map<uint32_t, Color4f> & originalIDToColor,
-  const std::set<uint32_t> & subtractedIDs)
+  const std::set<uint32_t> & subtractedIDs,
+  bool singlePrecision)
     : manifold_(std::move(mani)),
       originalIDs_(originalIDs),
       originalIDToColor_(originalIDToColor),
-      subtractedIDs_(subtractedIDs)
+      subtractedIDs_(subtractedIDs),
+      singlePrecision_(singlePrecision)
 {
 }
 
@@ -109,7 +111,12 @@ std::string ManifoldGeometry::dump() const {
 }
 
 std::shared_ptr<PolySet> ManifoldGeometry::toPolySet() const {
-  manifold::MeshGL64 mesh = getManifold().GetMeshGL64();
+  if (singlePrecision_) return toPolySet(getManifold().GetMeshGL());
+  return toPolySet(getManifold().GetMeshGL64());
+}
+
+template <class MeshGL>
+std::shared_ptr<PolySet> ManifoldGeometry::toPolySet(const MeshGL& mesh) const {
   auto ps = std::make_shared<PolySet>(3);
   ps->setTriangular(true);
   ps->vertices.reserve(mesh.NumVert());
@@ -194,7 +201,7 @@ std::shared_ptr<PolySet> ManifoldGeometry::toPolySet() const {
 }
 
 #ifdef ENABLE_CGAL
-template <typename Polyhedron>
+template <typename Polyhedron, typename MeshGL>
 class CGALPolyhedronBuilderFromManifold : public CGAL::Modifier_base<typename Polyhedron::HalfedgeDS>
 {
   using HDS = typename Polyhedron::HalfedgeDS;
@@ -202,8 +209,8 @@ class CGALPolyhedronBuilderFromManifold : public CGAL::Modifier_base<typename Po
 public:
   using CGALPoint = typename CGAL_Polybuilder::Point_3;
 
-  const manifold::MeshGL64& meshgl;
-  CGALPolyhedronBuilderFromManifold(const manifold::MeshGL64& mesh) : meshgl(mesh) { }
+  const MeshGL& meshgl;
+  CGALPolyhedronBuilderFromManifold(const MeshGL& mesh) : meshgl(mesh) { }
 
   void operator()(HDS& hds) override {
     CGAL_Polybuilder B(hds, true);
@@ -229,9 +236,15 @@ std::shared_ptr<Polyhedron> ManifoldGeometry::toPolyhedron() const
 {
   auto p = std::make_shared<Polyhedron>();
   try {
-    auto meshgl = getManifold().GetMeshGL64();
-    CGALPolyhedronBuilderFromManifold<Polyhedron> builder(meshgl);
-    p->delegate(builder);
+    if (singlePrecision_) {
+      auto meshgl = getManifold().GetMeshGL();
+      CGALPolyhedronBuilderFromManifold<Polyhedron, manifold::MeshGL> builder(meshgl);
+      p->delegate(builder);
+    } else {
+      auto meshgl = getManifold().GetMeshGL64();
+      CGALPolyhedronBuilderFromManifold<Polyhedron, manifold::MeshGL64> builder(meshgl);
+      p->delegate(builder);
+    }
   } catch (const CGAL::Assertion_exception& e) {
     LOG(message_group::Error, "CGAL error in CGALUtils::createPolyhedronFromPolySet: %1$s", e.what());
   }
@@ -330,6 +343,8 @@ void ManifoldGeometry::transform(const Transform3d& mat) {
     {mat(0, 3), mat(1, 3), mat(2, 3)}
   );
   manifold_ = getManifold().Transform(glMat);
+  // Transformed coordinates are generally not float-exact anymore
+  singlePrecision_ = false;
 }
 
 void ManifoldGeometry::setColor(const Color4f& c) {
@@ -368,11 +383,14 @@ void ManifoldGeometry::resize(const Vector3d& newsize, const Eigen::Matrix<bool,
 
 /*! Iterate over all vertices' points until the function returns true (for done). */
 void ManifoldGeometry::foreachVertexUntilTrue(const std::function<bool(const manifold::vec3& pt)>& f) const {
-  auto mesh = getManifold().GetMeshGL64();
-  const auto numVert = mesh.NumVert();
-  for (size_t v = 0; v < numVert; ++v) {
-    if (f(mesh.GetVertPos(v))) {
-      return;
+  const auto visit = [&f](const auto& mesh) {
+    const auto numVert = mesh.NumVert();
+    for (size_t v = 0; v < numVert; ++v) {
+      if (f(vector_convert<manifold::vec3>(mesh.GetVertPos(v)))) {
+        return;
+      }
     }
-  }
+  };
+  if (singlePrecision_) visit(getManifold().GetMeshGL());
+  else visit(getManifold().GetMeshGL64());
 }
@@ -28,7 +28,8 @@ public:
     manifold::Manifold object,
     const std::set<uint32_t> & originalIDs = {},
     const std::map<uint32_t, Color4f> & originalIDToColor = {},
-    const std::set<uint32_t> & subtractedIDs = {});
+    const std::set<uint32_t> & subtractedIDs = {},
+    bool singlePrecision = false);
    ManifoldGeometry(const ManifoldGeometry& other) = default;
 
   [[nodiscard]] bool isEmpty() const override;
@@ -71,12 +72,17 @@ public:
   void foreachVertexUntilTrue(const std::function<bool(const manifold::vec3& pt)>& f) const;
 
   const manifold::Manifold& getManifold() const;
+  /*! True if all vertices are exactly representable in float, so meshes can be exchanged as manifold::MeshGL. */
+  [[nodiscard]] bool isSinglePrecision() const { return singlePrecision_; }
 
 private:
   ManifoldGeometry binOp(const ManifoldGeometry& lhs, const ManifoldGeometry& rhs, manifold::OpType opType) const;
+  template <class MeshGL>
+  [[nodiscard]] std::shared_ptr<PolySet> toPolySet(const MeshGL& mesh) const;
 
   manifold::Manifold manifold_;
   std::set<uint32_t> originalIDs_;
   std::map<uint32_t, Color4f> originalIDToColor_;
   std::set<uint32_t> subtractedIDs_;
+  bool singlePrecision_ = false;
 };
@@ -1,6 +1,7 @@
 // Portions of this file are Copyright 2023 Google LLC, and licensed under GPL2+. See COPYING.
 #include "geometry/manifold/manifoldutils.h"
 #include "geometry/Geometry.h"
+#include "geometry/GeometryCache.h"
 #include "geometry/linalg.h"
 #include "geometry/manifold/ManifoldGeometry.h"
 #include "geometry/PolySetBuilder.h"
@@ -8,12 +9,8 @@
 #include "utils/printutils.h"
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/cgalutils.h"
-#include <cassert>
-#include <map>
-#include <set>
 #include <exception>
 #include <utility>
-#include <cstdint>
 #include <memory>
 #include <CGAL/convex_hull_3.h>
 #include <CGAL/Surface_mesh.h>
@@ -22,8 +19,11 @@
 #include "geometry/PolySet.h"
 #include <manifold/polygon.h>
 
+#include <cassert>
 #include <cstddef>
-#include <optional>
+#include <cstdint>
+#include <map>
+#include <set>
 #include <vector>
 
 using Error = manifold::Manifold::Error;
@@ -98,56 +98,110 @@ template std::shared_ptr<ManifoldGeometry> createManifoldFromSurfaceMesh(const C
 template std::shared_ptr<ManifoldGeometry> createManifoldFromSurfaceMesh(const CGAL_DoubleMesh &tm);
 #endif
 
-std::shared_ptr<ManifoldGeometry> createManifoldFromTriangularPolySet(const PolySet& ps)
+namespace {
+
+/*!
+   True if all coordinates survive a round-trip through float, e.g. for imported STL data.
+ */
+bool isFloatExact(const std::vector<Vector3d>& vertices)
 {
-  assert(ps.isTriangular());
+  for (const auto& v : vertices) {
+    for (int i = 0; i < 3; ++i) {
+      if (static_cast<double>(static_cast<float>(v[i])) != v[i]) return false;
+    }
+  }
+  return true;
+}
 
-  manifold::MeshGL64 mesh;
+/*!
+   Builds a mesh with one run per distinct face color, plus a leading run for uncolored faces.
+   Faces are bucketed into their runs by a counting sort over the color indices.
+ */
+template <typename MeshGL>
+MeshGL createMeshGLFromTriangularPolySet(const PolySet& ps, std::set<uint32_t>& originalIDs,
+                                         std::map<uint32_t, Color4f>& originalIDToColor)
+{
+  using Precision = typename decltype(MeshGL::vertProperties)::value_type;
+  using Index = typename decltype(MeshGL::triVerts)::value_type;
 
+  MeshGL mesh;
   mesh.numProp = 3;
   mesh.vertProperties.reserve(ps.vertices.size() * 3);
   for (const auto& v : ps.vertices) {
-    mesh.vertProperties.push_back(v.x());
-    mesh.vertProperties.push_back(v.y());
-    mesh.vertProperties.push_back(v.z());
+    mesh.vertProperties.push_back(static_cast<Precision>(v.x()));
+    mesh.vertProperties.push_back(static_cast<Precision>(v.y()));
+    mesh.vertProperties.push_back(static_cast<Precision>(v.z()));
   }
 
-  mesh.triVerts.reserve(ps.indices.size() * 3);
-
-  std::set<uint32_t> originalIDs;
-  std::map<uint32_t, Color4f> originalIDToColor;
+  // Equal colors share a run, ordered by color
+  std::map<Color4f, size_t> colorToRun;
+  for (const auto& color : ps.colors) colorToRun.emplace(color, 0);
+  std::vector<const Color4f *> runColor{nullptr};
+  for (auto& [color, run] : colorToRun) {
+    run = runColor.size();
+    runColor.push_back(&color);
+  }
+  std::vector<size_t> colorIndexToRun(ps.colors.size());
+  for (size_t i = 0; i < ps.colors.size(); ++i) colorIndexToRun[i] = colorToRun[ps.colors[i]];
+
+  const size_t numFaces = ps.indices.size();
+  std::vector<size_t> faceRun(numFaces, 0);
+  std::vector<size_t> runStart(runColor.size() + 1, 0);
+  for (size_t i = 0; i < numFaces; ++i) {
+    const auto color_index = i < ps.color_indices.size() ? ps.color_indices[i] : -1;
+    if (color_index >= 0) faceRun[i] = colorIndexToRun[color_index];
+    ++runStart[faceRun[i] + 1];
+  }
+  size_t numRuns = 0;
+  for (size_t run = 0; run < runColor.size(); ++run) {
+    if (runStart[run + 1] > 0) ++numRuns;
+    runStart[run + 1] += runStart[run];
+  }
 
-  std::map<std::optional<Color4f>, std::vector<size_t>> colorToFaceIndices;
-  for (size_t i = 0, n = ps.indices.size(); i < n; i++) {
-    auto color_index = i < ps.color_indices.size() ? ps.color_indices[i] : -1;
-    std::optional<Color4f> color;
-    if (color_index >= 0) {
-      color = ps.colors[color_index];
-    }
-    colorToFaceIndices[color].push_back(i);
+  mesh.triVerts.resize(numFaces * 3);
+  auto next = runStart;
+  for (size_t i = 0; i < numFaces; ++i) {
+    const auto& face = ps.indices[i];
+    assert(face.size() == 3);
+    const size_t offset = 3 * next[faceRun[i]]++;
+    mesh.triVerts[offset] = static_cast<Index>(face[0]);
+    mesh.triVerts[offset + 1] = static_cast<Index>(face[1]);
+    mesh.triVerts[offset + 2] = static_cast<Index>(face[2]);
   }
-  auto next_id = manifold::Manifold::ReserveIDs(colorToFaceIndices.size());
-  for (const auto& [color, faceIndices] : colorToFaceIndices) {
 
+  auto next_id = manifold::Manifold::ReserveIDs(numRuns);
+  for (size_t run = 0; run < runColor.size(); ++run) {
+    if (runStart[run + 1] == runStart[run]) continue;
     auto id = next_id++;
-    if (color.has_value()) {
-      originalIDToColor[id] = color.value();
+    if (runColor[run]) {
+      originalIDToColor[id] = *runColor[run];
     }
-
-    mesh.runIndex.push_back(mesh.triVerts.size());
+    mesh.runIndex.push_back(static_cast<Index>(3 * runStart[run]));
     mesh.runOriginalID.push_back(id);
     originalIDs.insert(id);
+  }
+  mesh.runIndex.push_back(static_cast<Index>(mesh.triVerts.size()));
+  return mesh;
+}
 
-    for (size_t faceIndex : faceIndices) {
-      auto & face = ps.indices[faceIndex];
-      assert(face.size() == 3);
-      mesh.triVerts.push_back(face[0]);
-      mesh.triVerts.push_back(face[1]);
-      mesh.triVerts.push_back(face[2]);
-    }
+} // namespace
+
+std::shared_ptr<ManifoldGeometry> createManifoldFromTriangularPolySet(const PolySet& ps)
+{
+  assert(ps.isTriangular());
+
+  std::set<uint32_t> originalIDs;
+  std::map<uint32_t, Color4f> originalIDToColor;
+
+  // Single precision halves the size of the mesh, and the result remembers it so
+  // converting back doesn't lose anything.
+  if (Feature::ExperimentalManifoldFloatMesh.is_enabled() && isFloatExact(ps.vertices)) {
+    auto mesh = createMeshGLFromTriangularPolySet<manifold::MeshGL>(ps, originalIDs, originalIDToColor);
+    auto mani = manifold::Manifold(mesh);
+    return std::make_shared<ManifoldGeometry>(mani, originalIDs, originalIDToColor, std::set<uint32_t>{}, true);
   }
-  mesh.runIndex.push_back(mesh.triVerts.size());
 
+  auto mesh = createMeshGLFromTriangularPolySet<manifold::MeshGL64>(ps, originalIDs, originalIDToColor);
   auto mani = manifold::Manifold(mesh);
   return std::make_shared<ManifoldGeometry>(mani, originalIDs, originalIDToColor);
 }
@@ -240,10 +294,13 @@ std::shared_ptr<const ManifoldGeometry> createManifoldFromGeometry(const std::sh
   if (auto mani = std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
     return mani;
   }
-  if (auto ps = PolySetUtils::getGeometryAsPolySet(geom)) {
-    return createManifoldFromPolySet(*ps);
-  }
-  return nullptr;
+  // Cached geometries are often used in many booleans, so keep their Manifold around
+  return GeometryCache::instance()->convert<ManifoldGeometry>(geom, [&]() -> std::shared_ptr<const ManifoldGeometry> {
+    if (auto ps = PolySetUtils::getGeometryAsPolySet(geom)) {
+      return createManifoldFromPolySet(*ps);
+    }
+    return nullptr;
+  });
 }
 
 Polygon2d polygonsToPolygon2d(const manifold::Polygons& polygons) {
@@ -37,7 +37,7 @@ public:
       if (normalizedRoot) {
         this->root_products.reset(new CSGProducts());
         this->root_products->import(normalizedRoot);
-        LOG("Normalized CSG tree has %1$d elements", int(this->root_products->size()));
+        LOG("Normalized CSG tree has %1$d elements (%2$d terms)", int(this->root_products->size()), normalizer.getTermCount());
       } else {
         this->root_products.reset();
         LOG(message_group::Warning, "CSG normalization resulted in an empty tree");
@@ -7,6 +7,7 @@
 #include "glview/Renderer.h"
 #include "utils/degree_trig.h"
 #include "glview/hershey.h"
+#include "Feature.h"
 
 #include <functional>
 #include <memory>
@@ -25,6 +26,7 @@ GLView::GLView()
   showaxes = false;
   showcrosshairs = false;
   showscale = false;
+  lod = false;
   colorscheme = &ColorMap::inst()->defaultColorScheme();
   cam = Camera();
   far_far_away = RenderSettings::inst()->far_gl_clip_limit;
@@ -205,6 +207,12 @@ void GLView::paintGL()
     // FIXME: This belongs in the OpenCSG renderer, but it doesn't know about this ID yet
     OpenCSG::setContext(this->opencsg_id);
 #endif
+    if (this->lod && Feature::ExperimentalPreviewLOD.is_enabled()) {
+      // Both projections show 2 * dist * tan(fov / 2) units vertically at the view center
+      this->renderer->setLODScale(cam.pixel_height / (2 * cam.zoomValue() * tan_degrees(cam.fov / 2)));
+    } else {
+      this->renderer->setLODScale(0);
+    }
     this->renderer->prepare(edge_shader.get());
     this->renderer->draw(showedges, edge_shader.get());
   }
@@ -60,6 +60,9 @@ public:
   void setShowEdges(bool enabled) { this->showedges = enabled; }
   [[nodiscard]] bool showCrosshairs() const { return this->showcrosshairs; }
   void setShowCrosshairs(bool enabled) { this->showcrosshairs = enabled; }
+  // Draw simplified meshes for small objects (interactive views only, never for exports)
+  [[nodiscard]] bool levelOfDetail() const { return this->lod; }
+  void setLevelOfDetail(bool enabled) { this->lod = enabled; }
 
   virtual bool save(const char *filename) const = 0;
   [[nodiscard]] virtual std::string getRendererInfo() const = 0;
@@ -75,6 +78,7 @@ public:
   bool showedges;
   bool showcrosshairs;
   bool showscale;
+  bool lod;
   GLdouble modelview[16];
   GLdouble projection[16];
   std::vector<SelectedObject> selected_obj;
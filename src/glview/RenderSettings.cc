@@ -7,6 +7,8 @@ std::string renderBackend3DToString(RenderBackend3D backend) {
   switch (backend) {
   case RenderBackend3D::CGALBackend:
     return "CGAL";
+  case RenderBackend3D::CGALCorefinementBackend:
+    return "CGAL-Corefinement";
   case RenderBackend3D::ManifoldBackend:
     return "Manifold";
   default:
@@ -18,6 +20,8 @@ RenderBackend3D renderBackend3DFromString(std::string backend) {
   boost::algorithm::to_lower(backend);
   if (backend == "cgal") {
     return RenderBackend3D::CGALBackend;
+  } else if (backend == "cgal-corefinement") {
+    return RenderBackend3D::CGALCorefinementBackend;
   } else if (backend == "manifold") {
     return RenderBackend3D::ManifoldBackend;
   } else {
@@ -5,6 +5,7 @@
 enum class RenderBackend3D {
   UnknownBackend,
   CGALBackend,
+  CGALCorefinementBackend,
   ManifoldBackend,
 };
 
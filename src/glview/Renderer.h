@@ -60,6 +60,9 @@ public:
   bool getColorSchemeColor(ColorMode colormode, Color4f& outcolor) const;
   bool getShaderColor(Renderer::ColorMode colormode, const Color4f& object_color, Color4f& outcolor) const;
   virtual void setColorScheme(const ColorScheme& cs);
+  // Scale of the view in pixels per model unit, used to pick simplified meshes
+  // for small objects. 0 always draws full resolution meshes.
+  virtual void setLODScale(double /*pixels_per_unit*/) {}
 
   virtual std::vector<SelectedObject> findModelObject(Vector3d near_pt, Vector3d far_pt, int mouse_x, int mouse_y, double tolerance);
 
@@ -1,8 +1,10 @@
 #include "glview/VBOBuilder.h"
 
 #include <unordered_map>
+#include <cstdint>
 #include <cstring>
 #include <cassert>
+#include <algorithm>
 #include <array>
 #include <utility>
 #include <vector>
@@ -11,6 +13,8 @@
 
 #include "geometry/linalg.h"
 #include "geometry/Polygon2d.h"
+#include "glview/VBOInstancePlan.h"
+#include "glview/VBOSurfaceWriter.h"
 #include "utils/printutils.h"
 #include "utils/hash.h"  // IWYU pragma: keep
 
@@ -423,10 +427,11 @@ void VBOBuilder::create_surface(const PolySet& ps, const Transform3d& m,
     return;
   }
 
-  const bool mirrored = m.matrix().determinant() < 0;
-  size_t triangle_count = 0;
+  if (instance_plan_ && instance_plan_->isInstanced(ps, m)) {
+    create_surface_instance(ps, m, default_color, enable_barycentric);
+    return;
+  }
 
-  std::unordered_map<Vector3d, Vector3d> vert_mult_map;
   const auto last_size = verticesOffset();
 
   size_t elements_offset = 0;
@@ -435,6 +440,38 @@ void VBOBuilder::create_surface(const PolySet& ps, const Transform3d& m,
     elementsMap().clear();
   }
 
+  const size_t draw_size = write_surface(ps, m, default_color, enable_barycentric, force_default_color);
+
+  GLenum elements_type = 0;
+  if (useElements()) elements_type = elementsData()->glType();
+  std::shared_ptr<VertexState> vertex_state = createVertexState(
+    GL_TRIANGLES, draw_size, elements_type, writeIndex(), elements_offset);
+  vertex_state_container_.states().emplace_back(std::move(vertex_state));
+  addAttributePointers(last_size);
+}
+
+// Writes the triangles of the PolySet, transformed by m, to the current VertexData.
+// Returns the number of vertices written.
+size_t VBOBuilder::write_surface(const PolySet& ps, const Transform3d& m, const Color4f& default_color,
+                                 bool enable_barycentric, bool force_default_color)
+{
+  // With a preallocated, non-indexed buffer every vertex has a known
+  // destination, so the surface is written directly and in parallel.
+  VBOSurfaceLayout layout;
+  if (!useElements() && !interleaved_buffer_.empty() && surfaceLayout(enable_barycentric, layout)) {
+    const size_t num_vertices = VBOUtils::numSurfaceVertices(ps);
+    assert(vertices_offset_ + num_vertices * layout.stride <= interleaved_buffer_.size());
+    VBOUtils::writeSurfaceVertices(ps, m, default_color, force_default_color, layout,
+                                   reinterpret_cast<uint8_t *>(interleaved_buffer_.data() + vertices_offset_));
+    vertices_offset_ += num_vertices * layout.stride;
+    return num_vertices;
+  }
+
+  const bool mirrored = m.matrix().determinant() < 0;
+  size_t triangle_count = 0;
+
+  std::unordered_map<Vector3d, Vector3d> vert_mult_map;
+
   auto has_colors = !ps.color_indices.empty();
 
   for (int i = 0, n = ps.indices.size(); i < n; i++) {
@@ -476,13 +513,83 @@ void VBOBuilder::create_surface(const PolySet& ps, const Transform3d& m,
       }
     }
   }
+  return triangle_count * 3;
+}
+
+// Draws a surface shared between several leaves. The PolySet is written
+// untransformed on first use; every leaf gets its own VertexState reading that
+// range, with m applied as model matrix and color set as the current color.
+void VBOBuilder::create_surface_instance(const PolySet& ps, const Transform3d& m,
+                                         const Color4f& color, bool enable_barycentric)
+{
+  auto surface = shared_surfaces_.find(&ps);
+  if (surface == shared_surfaces_.end()) {
+    SharedSurface shared{verticesOffset(), 0, 0};
+    if (useElements()) {
+      shared.elements_offset = elementsOffset();
+      elementsMap().clear();
+    }
+    shared.draw_size = write_surface(ps, Transform3d::Identity(), color, enable_barycentric, true);
+    surface = shared_surfaces_.emplace(&ps, shared).first;
+  }
+  const SharedSurface& shared = surface->second;
 
   GLenum elements_type = 0;
   if (useElements()) elements_type = elementsData()->glType();
   std::shared_ptr<VertexState> vertex_state = createVertexState(
-    GL_TRIANGLES, triangle_count * 3, elements_type, writeIndex(), elements_offset);
-  vertex_state_container_.states().emplace_back(std::move(vertex_state));
-  addAttributePointers(last_size);
+    GL_TRIANGLES, shared.draw_size, elements_type, writeIndex(), shared.elements_offset);
+  std::array<GLdouble, 16> model_matrix;
+  std::copy(m.data(), m.data() + 16, model_matrix.begin());
+  vertex_state->setModelMatrix(model_matrix);
+  vertex_state_container_.states().emplace_back(vertex_state);
+  addAttributePointers(shared.vertices_offset);
+
+  // The color baked into the shared vertices belongs to the first leaf
+  if (data()->hasColorData()) {
+    vertex_state->glBegin().emplace_back([color]() {
+      GL_TRACE0("glDisableClientState(GL_COLOR_ARRAY)");
+      GL_CHECKD(glDisableClientState(GL_COLOR_ARRAY));
+      GL_TRACE("glColor4f(%f, %f, %f, %f)", color[0] % color[1] % color[2] % color[3]);
+      GL_CHECKD(glColor4f(color[0], color[1], color[2], color[3]));
+    });
+  }
+}
+
+// Describes the current VertexData for VBOUtils::writeSurfaceVertices(), if it
+// holds exactly the attributes create_triangle() would write.
+bool VBOBuilder::surfaceLayout(bool enable_barycentric, VBOSurfaceLayout& layout) const
+{
+  const auto& vertex_data = vertices_[write_index_];
+  if (!vertex_data->hasPositionData() || !vertex_data->hasNormalData() || !vertex_data->hasColorData()) return false;
+  const auto is_float = [](const IAttributeData& data, size_t count) {
+    return data.glType() == GL_FLOAT && data.count() == count && data.sizeofType() == sizeof(float);
+  };
+  if (!is_float(*vertex_data->positionData(), 3) || !is_float(*vertex_data->normalData(), 3) ||
+      !is_float(*vertex_data->colorData(), 4)) return false;
+  if (vertex_data->attributes().size() != (enable_barycentric ? 4 : 3)) return false;
+
+  layout.stride = vertex_data->stride();
+  layout.position_offset = vertex_data->interleavedOffset(vertex_data->positionIndex());
+  layout.normal_offset = vertex_data->interleavedOffset(vertex_data->normalIndex());
+  layout.color_offset = vertex_data->interleavedOffset(vertex_data->colorIndex());
+  layout.barycentric_offset.reset();
+  if (enable_barycentric) {
+    const auto index = shader_attributes_index_ + BARYCENTRIC_ATTRIB;
+    if (index >= vertex_data->attributes().size()) return false;
+    const auto& barycentric = vertex_data->attributes()[index];
+    if (barycentric->glType() != GL_UNSIGNED_BYTE || barycentric->count() != 4) return false;
+    layout.barycentric_offset = vertex_data->interleavedOffset(index);
+  }
+  return true;
+}
+
+size_t VBOBuilder::surfaceOffset(const PolySet& ps, const Transform3d& m) const
+{
+  if (instance_plan_ && instance_plan_->isInstanced(ps, m)) {
+    const auto surface = shared_surfaces_.find(&ps);
+    if (surface != shared_surfaces_.end()) return surface->second.vertices_offset;
+  }
+  return verticesOffset();
 }
 
 void VBOBuilder::create_edges(const Polygon2d& polygon,
@@ -18,6 +18,9 @@
 #include "Feature.h"
 #include "glview/VertexState.h"
 
+class VBOInstancePlan;
+struct VBOSurfaceLayout;
+
 enum ShaderAttribIndex {
   BARYCENTRIC_ATTRIB
 };
@@ -339,11 +342,29 @@ public:
                        size_t shape_size, bool outlines, bool enable_barycentric, bool mirror);
   void create_surface(const PolySet& ps, const Transform3d& m,
                       const Color4f& default_color, bool enable_barycentric, bool force_default_color=false);
+
+  // Share surfaces between CSG leaves as decided by plan, which must outlive
+  // the create_surface() calls. Pass nullptr to write every surface separately.
+  inline void setInstancePlan(const VBOInstancePlan *plan) { instance_plan_ = plan; }
+  // Return the vertex buffer offset the surface for ps placed by m will be read from
+  size_t surfaceOffset(const PolySet& ps, const Transform3d& m) const;
   void create_edges(const Polygon2d& polygon, const Transform3d& m, const Color4f& color);
   void create_polygons(const PolySet& ps, const Transform3d& m, const Color4f& color);
 
 private:
+  // Location of a surface written once and drawn by several leaves
+  struct SharedSurface {
+    size_t vertices_offset;
+    size_t elements_offset;
+    size_t draw_size;
+  };
+
   inline void setElementsSize(size_t elements_size) { elements_size_ = elements_size; }
+  bool surfaceLayout(bool enable_barycentric, VBOSurfaceLayout& layout) const;
+  size_t write_surface(const PolySet& ps, const Transform3d& m, const Color4f& default_color,
+                       bool enable_barycentric, bool force_default_color);
+  void create_surface_instance(const PolySet& ps, const Transform3d& m,
+                               const Color4f& color, bool enable_barycentric);
 
   std::unique_ptr<VertexStateFactory> factory_;
   VertexStateContainer& vertex_state_container_;
@@ -363,4 +384,7 @@ private:
 
   VertexData elements_;
   ElementsMap elements_map_;
+
+  const VBOInstancePlan *instance_plan_{nullptr};
+  std::unordered_map<const PolySet *, SharedSurface> shared_surfaces_;
 };
@@ -0,0 +1,47 @@
+#include "glview/VBOInstancePlan.h"
+
+#include <cstddef>
+
+#include "geometry/linalg.h"
+#include "geometry/PolySet.h"
+
+bool VBOInstancePlan::canInstance(const PolySet& ps)
+{
+  return ps.color_indices.empty();
+}
+
+void VBOInstancePlan::add(const PolySet& ps, const Transform3d& m, size_t num_vertices)
+{
+  num_vertices_unshared_ += num_vertices;
+  if (!canInstance(ps) || !canInstance(m)) {
+    num_vertices_fixed_ += num_vertices;
+    return;
+  }
+  auto& uses = uses_.emplace(&ps, Uses{num_vertices, 0}).first->second;
+  uses.count++;
+}
+
+bool VBOInstancePlan::isInstanced(const PolySet& ps, const Transform3d& m) const
+{
+  if (!canInstance(m)) return false;
+  const auto it = uses_.find(&ps);
+  return it != uses_.end() && it->second.count > 1;
+}
+
+size_t VBOInstancePlan::numVertices() const
+{
+  size_t num_vertices = num_vertices_fixed_;
+  for (const auto& [ps, uses] : uses_) {
+    num_vertices += uses.count > 1 ? uses.num_vertices : uses.num_vertices * uses.count;
+  }
+  return num_vertices;
+}
+
+size_t VBOInstancePlan::numInstances() const
+{
+  size_t instances = 0;
+  for (const auto& [ps, uses] : uses_) {
+    if (uses.count > 1) instances += uses.count;
+  }
+  return instances;
+}
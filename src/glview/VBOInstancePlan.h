@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "geometry/linalg.h"
+
+class PolySet;
+
+// Decides which surfaces of a VBO are shared between several CSG leaves.
+// Leaves referencing the same PolySet are written to the vertex buffer once,
+// untransformed, and every leaf draws that range under its own model matrix
+// and color (see VBOBuilder::setInstancePlan()).
+// No OpenGL calls are made here, so buffer sizes can be computed up front
+// without a context.
+class VBOInstancePlan
+{
+public:
+  // Register one surface of num_vertices vertices for ps, placed by m
+  void add(const PolySet& ps, const Transform3d& m, size_t num_vertices);
+
+  // Return whether the surface for ps placed by m is drawn from a shared range
+  [[nodiscard]] bool isInstanced(const PolySet& ps, const Transform3d& m) const;
+  // Number of vertices to allocate when shared surfaces are written once
+  [[nodiscard]] size_t numVertices() const;
+  // Number of vertices to allocate when every surface is written separately
+  [[nodiscard]] size_t numVerticesUnshared() const { return num_vertices_unshared_; }
+  // Number of surfaces drawn from a shared range
+  [[nodiscard]] size_t numInstances() const;
+
+  // Mirroring transforms flip winding and normals, which the CPU path handles
+  // by reordering vertices, so only orientation preserving placements are shared.
+  static bool canInstance(const Transform3d& m) { return m.matrix().determinant() > 0; }
+  // Per-face colors are baked into the vertex data and can't vary per instance
+  static bool canInstance(const PolySet& ps);
+
+private:
+  struct Uses {
+    size_t num_vertices;
+    size_t count;
+  };
+
+  std::unordered_map<const PolySet *, Uses> uses_;
+  size_t num_vertices_unshared_{0};
+  size_t num_vertices_fixed_{0};
+};
@@ -27,12 +27,15 @@
 #include "glview/VBORenderer.h"
 #include "geometry/linalg.h"
 #include "geometry/Polygon2d.h"
+#include "geometry/LODCache.h"
 #include "geometry/PolySet.h"
+#include "glview/VBOSurfaceWriter.h"
 #include "core/CSGNode.h"
 #include "utils/printutils.h"
 #include "utils/hash.h"  // IWYU pragma: keep
 
 #include <cassert>
+#include <cmath>
 #include <array>
 #include <unordered_map>
 #include <utility>
@@ -61,6 +64,49 @@ void shader_attribs_disable(const ShaderUtils::ShaderInfo& shaderinfo)
 
 VBORenderer::VBORenderer() : Renderer() {}
 
+void VBORenderer::setLODScale(double pixels_per_unit)
+{
+  // Round to a power of two, so zooming only rebuilds VBOs every factor of two
+  const double scale = pixels_per_unit > 0 ? std::exp2(std::round(std::log2(pixels_per_unit))) : 0.0;
+  if (scale != lod_scale_) {
+    lod_scale_ = scale;
+    lod_changed_ = true;
+  } else if (lod_pending_ && LODCache::instance()->generation() != lod_generation_) {
+    // Levels missing from the last build may be ready now
+    lod_changed_ = true;
+  }
+}
+
+void VBORenderer::beginLOD()
+{
+  lod_meshes_.clear();
+  lod_changed_ = false;
+  lod_pending_ = false;
+  lod_generation_ = LODCache::instance()->generation();
+}
+
+std::shared_ptr<const PolySet> VBORenderer::lodPolySet(const std::shared_ptr<const PolySet>& ps, const Transform3d& m) const
+{
+  if (lod_scale_ <= 0 || !ps || ps->getDimension() != 3 || ps->indices.size() < LODCache::MIN_FACES) return ps;
+
+  // Pick the coarsest level whose cells are at most two pixels on screen
+  const double extent = ps->getBoundingBox().sizes().maxCoeff() * m.linear().colwise().norm().maxCoeff();
+  const double pixels = extent * lod_scale_;
+  int level = 0;
+  while (level < LODCache::NUM_LEVELS && LODCache::resolution(level) * 2 < pixels) level++;
+  if (level == LODCache::NUM_LEVELS) return ps;
+
+  auto& mesh = lod_meshes_[std::make_pair(ps.get(), level)];
+  if (!mesh) {
+    mesh = LODCache::instance()->get(ps, level);
+    if (!mesh) {
+      lod_pending_ = true;
+      mesh = ps;
+    }
+  }
+  return mesh;
+}
+
 size_t VBORenderer::calcNumVertices(const std::shared_ptr<CSGProducts>& products,
                                          bool unique_geometry) const
 {
@@ -93,19 +139,7 @@ size_t VBORenderer::calcNumVertices(const CSGChainObject& csgobj, bool unique_ge
 
 size_t VBORenderer::calcNumVertices(const PolySet& polyset) const
 {
-  size_t buffer_size = 0;
-  for (const auto& poly : polyset.indices) {
-    if (poly.size() == 3) {
-      buffer_size++;
-    } else if (poly.size() == 4) {
-      buffer_size += 2;
-    } else {
-      // poly.size() because we'll render a triangle fan from the centroid
-      // FIXME: Are we still using this code path?
-      buffer_size += poly.size();
-    }
-  }
-  return buffer_size * 3;
+  return VBOUtils::numSurfaceVertices(polyset);
 }
 
 size_t VBORenderer::calcNumEdgeVertices(const PolySet& polyset) const
@@ -128,13 +162,16 @@ size_t VBORenderer::calcNumEdgeVertices(const Polygon2d& polygon) const
 }
 
 void VBORenderer::add_shader_pointers(VBOBuilder& vbo_builder, const ShaderUtils::ShaderInfo *shaderinfo)
+{
+  add_shader_pointers(vbo_builder, shaderinfo, vbo_builder.verticesOffset());
+}
+
+void VBORenderer::add_shader_pointers(VBOBuilder& vbo_builder, const ShaderUtils::ShaderInfo *shaderinfo, size_t start_offset)
 {
   const std::shared_ptr<VertexData> vertex_data = vbo_builder.data();
 
   if (!vertex_data) return;
 
-  const auto start_offset = vbo_builder.verticesOffset();
-
   std::shared_ptr<VertexState> ss = std::make_shared<VBOShaderVertexState>(
     vbo_builder.writeIndex(), 0, vbo_builder.verticesVBO(), vbo_builder.elementsVBO());
   GLsizei count = 0, stride = 0;
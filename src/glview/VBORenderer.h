@@ -40,7 +40,11 @@ public:
   virtual size_t calcNumEdgeVertices(const PolySet& polyset) const;
   virtual size_t calcNumEdgeVertices(const Polygon2d& polygon) const;
 
+  void setLODScale(double pixels_per_unit) override;
+
   void add_shader_pointers(VBOBuilder& vbo_builder, const ShaderUtils::ShaderInfo *shaderinfo); // This could stay protected, were it not for VertexStateManager
+  // Point the shader attributes at vertices starting at start_offset, e.g. a surface shared between leaves
+  void add_shader_pointers(VBOBuilder& vbo_builder, const ShaderUtils::ShaderInfo *shaderinfo, size_t start_offset);
 
 protected:
   void add_shader_data(VBOBuilder& vbo_builder);
@@ -50,5 +54,19 @@ protected:
   mutable std::unordered_map<std::pair<const PolySet *, const Transform3d *>, int,
                              boost::hash<std::pair<const PolySet *, const Transform3d *>>> geom_visit_mark_;
 
+  // Return whether VBOs built since the last beginLOD() would pick different meshes now
+  [[nodiscard]] bool lodChanged() const { return lod_changed_; }
+  // Start picking meshes for a new set of VBOs
+  void beginLOD();
+  // Return the mesh to draw for ps placed by m at the current LOD scale.
+  // Returns the same mesh for the same arguments until the next beginLOD().
+  std::shared_ptr<const PolySet> lodPolySet(const std::shared_ptr<const PolySet>& ps, const Transform3d& m) const;
+
 private:
+  double lod_scale_{0};
+  bool lod_changed_{false};
+  unsigned int lod_generation_{0};
+  mutable bool lod_pending_{false};
+  mutable std::unordered_map<std::pair<const PolySet *, int>, std::shared_ptr<const PolySet>,
+                             boost::hash<std::pair<const PolySet *, int>>> lod_meshes_;
 };
@@ -0,0 +1,140 @@
+#include "glview/VBOSurfaceWriter.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "geometry/linalg.h"
+#include "geometry/PolySet.h"
+#include "utils/parallel.h"
+
+namespace {
+
+size_t numPolygonVertices(const IndexedFace& poly)
+{
+  if (poly.size() == 3) return 3;
+  if (poly.size() == 4) return 6;
+  // poly.size() triangles, rendered as a fan from the centroid
+  return poly.size() * 3;
+}
+
+class SurfaceVertexWriter
+{
+public:
+  SurfaceVertexWriter(const VBOSurfaceLayout& layout, uint8_t *dst) : layout_(layout), dst_(dst) {}
+
+  // Same vertex order, normal and barycentric flags as VBOBuilder::create_triangle()
+  void triangle(const Color4f& color, const Vector3d& p0, const Vector3d& p1, const Vector3d& p2,
+                size_t shape_size, bool mirror)
+  {
+    const double ax = p1[0] - p0[0], bx = p1[0] - p2[0];
+    const double ay = p1[1] - p0[1], by = p1[1] - p2[1];
+    const double az = p1[2] - p0[2], bz = p1[2] - p2[2];
+    const double nx = ay * bz - az * by;
+    const double ny = az * bx - ax * bz;
+    const double nz = ax * by - ay * bx;
+    const double nl = sqrt(nx * nx + ny * ny + nz * nz);
+    const Vector3d n = Vector3d(nx / nl, ny / nl, nz / nl);
+
+    const std::array<const Vector3d *, 3> points = {&p0, &p1, &p2};
+    const std::array<size_t, 3> order = mirror ? std::array<size_t, 3>{0, 2, 1} : std::array<size_t, 3>{0, 1, 2};
+    for (const auto active_point_index : order) {
+      vertex(*points[active_point_index], n, color, active_point_index, shape_size);
+    }
+  }
+
+private:
+  void vertex(const Vector3d& p, const Vector3d& n, const Color4f& color,
+              size_t active_point_index, size_t shape_size)
+  {
+    const std::array<float, 3> position = {(float)p[0], (float)p[1], (float)p[2]};
+    const std::array<float, 3> normal = {(float)n[0], (float)n[1], (float)n[2]};
+    const std::array<float, 4> rgba = {color[0], color[1], color[2], color[3]};
+    std::memcpy(dst_ + layout_.position_offset, position.data(), sizeof(position));
+    std::memcpy(dst_ + layout_.normal_offset, normal.data(), sizeof(normal));
+    std::memcpy(dst_ + layout_.color_offset, rgba.data(), sizeof(rgba));
+    if (layout_.barycentric_offset) {
+      // Surface (non-outline) flags, see VBOBuilder::add_barycentric_attribute()
+      std::array<uint8_t, 4> barycentric;
+      if (shape_size == 3) barycentric = {0, 0, 0, 0};
+      else if (shape_size == 4) barycentric = {1, 0, 0, 0};
+      else barycentric = {0, 1, 1, 0};
+      barycentric[active_point_index] = 1;
+      std::memcpy(dst_ + *layout_.barycentric_offset, barycentric.data(), sizeof(barycentric));
+    }
+    dst_ += layout_.stride;
+  }
+
+  const VBOSurfaceLayout& layout_;
+  uint8_t *dst_;
+};
+
+}  // namespace
+
+namespace VBOUtils {
+
+size_t numSurfaceVertices(const PolySet& ps)
+{
+  size_t num_vertices = 0;
+  for (const auto& poly : ps.indices) {
+    num_vertices += numPolygonVertices(poly);
+  }
+  return num_vertices;
+}
+
+void writeSurfaceVertices(const PolySet& ps, const Transform3d& m,
+                          const Color4f& default_color, bool force_default_color,
+                          const VBOSurfaceLayout& layout, uint8_t *dst)
+{
+  const bool mirrored = m.matrix().determinant() < 0;
+
+  std::vector<Vector3d> vertices(ps.vertices.size());
+  parallelizable_transform(ps.vertices.begin(), ps.vertices.end(), vertices.begin(),
+                           [&](const Vector3d& v) -> Vector3d { return m * v; });
+
+  // Destination of each polygon, so they can be written independently
+  std::vector<size_t> offsets(ps.indices.size());
+  size_t offset = 0;
+  for (size_t i = 0; i < ps.indices.size(); ++i) {
+    offsets[i] = offset;
+    offset += numPolygonVertices(ps.indices[i]) * layout.stride;
+  }
+
+  const bool has_colors = !ps.color_indices.empty();
+  parallelizable_for(0, ps.indices.size(), [&](size_t i) {
+    const auto& poly = ps.indices[i];
+    const auto color_index = has_colors && i < ps.color_indices.size() ? ps.color_indices[i] : -1;
+    const auto& color = !force_default_color && color_index >= 0 && color_index < ps.colors.size() &&
+                            ps.colors[color_index].isValid()
+                          ? ps.colors[color_index]
+                          : default_color;
+    SurfaceVertexWriter writer(layout, dst + offsets[i]);
+    if (poly.size() == 3) {
+      writer.triangle(color, vertices[poly[0]], vertices[poly[1]], vertices[poly[2]], poly.size(), mirrored);
+    } else if (poly.size() == 4) {
+      const auto& p0 = vertices[poly[0]];
+      const auto& p1 = vertices[poly[1]];
+      const auto& p2 = vertices[poly[2]];
+      const auto& p3 = vertices[poly[3]];
+      writer.triangle(color, p0, p1, p3, poly.size(), mirrored);
+      writer.triangle(color, p2, p3, p1, poly.size(), mirrored);
+    } else {
+      Vector3d center = Vector3d::Zero();
+      for (const auto& idx : poly) {
+        center += ps.vertices[idx];
+      }
+      center /= poly.size();
+      const Vector3d p0 = m * center;
+      for (size_t j = 1; j <= poly.size(); j++) {
+        const auto& p1 = vertices[poly[j % poly.size()]];
+        const auto& p2 = vertices[poly[j - 1]];
+        writer.triangle(color, p0, p2, p1, poly.size(), mirrored);
+      }
+    }
+  });
+}
+
+}  // namespace VBOUtils
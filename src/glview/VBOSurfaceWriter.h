@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "geometry/linalg.h"
+
+class PolySet;
+
+// Byte offsets of the surface attributes within one interleaved vertex, matching
+// the layout set up by VBOBuilder::addSurfaceData() and VBOBuilder::addShaderData():
+// position (3 floats), normal (3 floats), color (4 floats), barycentric (4 bytes).
+struct VBOSurfaceLayout {
+  size_t stride;
+  size_t position_offset;
+  size_t normal_offset;
+  size_t color_offset;
+  std::optional<size_t> barycentric_offset;
+};
+
+namespace VBOUtils {
+
+// Return the number of vertices written for the triangles of ps
+size_t numSurfaceVertices(const PolySet& ps);
+
+// Write the triangles of ps, transformed by m, as interleaved vertices to dst,
+// which must hold numSurfaceVertices(ps) * layout.stride bytes.
+// Produces the same vertices as VBOBuilder::create_triangle() for each polygon,
+// but computes each polygon's destination up front so that polygons are
+// written in parallel. No OpenGL calls are made.
+void writeSurfaceVertices(const PolySet& ps, const Transform3d& m,
+                          const Color4f& default_color, bool force_default_color,
+                          const VBOSurfaceLayout& layout, uint8_t *dst);
+
+}  // namespace VBOUtils
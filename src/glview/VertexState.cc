@@ -10,6 +10,12 @@ void VertexState::draw() const
     GL_TRACE("glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, %d)", elements_vbo_);
     GL_CHECKD(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elements_vbo_));
   }
+  if (model_matrix_) {
+    GL_TRACE0("glPushMatrix()");
+    GL_CHECKD(glPushMatrix());
+    GL_TRACE("glMultMatrixd(%p)", model_matrix_->data());
+    GL_CHECKD(glMultMatrixd(model_matrix_->data()));
+  }
   for (const auto& gl_func : gl_begin_) {
     gl_func();
   }
@@ -52,6 +58,10 @@ void VertexState::draw() const
   for (const auto& gl_func : gl_end_) {
     gl_func();
   }
+  if (model_matrix_) {
+    GL_TRACE0("glPopMatrix()");
+    GL_CHECKD(glPopMatrix());
+  }
   if (elements_vbo_) {
     GL_TRACE0("glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0)");
     GL_CHECKD(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <array>
 #include <utility>
 #include <memory>
+#include <optional>
 #include <cstddef>
 #include <functional>
 #include <vector>
@@ -73,6 +75,11 @@ public:
   [[nodiscard]] inline GLuint elementsVBO() const { return elements_vbo_; }
   inline void setElementsVBO(GLuint vbo) { elements_vbo_ = vbo; }
 
+  // Return the column major matrix multiplied onto the modelview matrix while drawing, if any.
+  // Used to draw vertices shared between several objects at each object's placement.
+  [[nodiscard]] inline const std::optional<std::array<GLdouble, 16>>& modelMatrix() const { return model_matrix_; }
+  inline void setModelMatrix(const std::optional<std::array<GLdouble, 16>>& model_matrix) { model_matrix_ = model_matrix; }
+
 private:
   GLenum draw_mode_;
   GLsizei draw_size_;
@@ -81,6 +88,7 @@ private:
   size_t element_offset_;
   GLuint vertices_vbo_;
   GLuint elements_vbo_;
+  std::optional<std::array<GLdouble, 16>> model_matrix_;
   std::vector<std::function<void()>> gl_begin_;
   std::vector<std::function<void()>> gl_end_;
 };
@@ -145,7 +145,7 @@ void CGALRenderer::createPolySetStates() {
 
   size_t num_vertices = 0;
   for (const auto &polyset : this->polysets_) {
-    num_vertices += calcNumVertices(*polyset);
+    num_vertices += calcNumVertices(*lodPolySet(polyset, Transform3d::Identity()));
   }
   vbo_builder.allocateBuffers(num_vertices);
 
@@ -153,7 +153,7 @@ void CGALRenderer::createPolySetStates() {
     Color4f color;
     getColorSchemeColor(ColorMode::MATERIAL, color);
     vbo_builder.writeSurface();
-    vbo_builder.create_surface(*polyset, Transform3d::Identity(), color, false);
+    vbo_builder.create_surface(*lodPolySet(polyset, Transform3d::Identity()), Transform3d::Identity(), color, false);
   }
 
   vbo_builder.createInterleavedVBOs();
@@ -235,7 +235,11 @@ void CGALRenderer::createPolygonEdgeStates() {
 
 void CGALRenderer::prepare(const ShaderUtils::ShaderInfo * /*shaderinfo*/) {
   PRINTD("prepare()");
+  if (lodChanged()) {
+    vertex_state_containers_.clear(); // Mark as dirty
+  }
   if (!vertex_state_containers_.size()) {
+    beginLOD();
     if (!this->polysets_.empty() && !this->polygons_.empty()) {
       LOG(message_group::Error, "CGALRenderer::prepare() called with both polysets and polygons");
     } else if (!this->polysets_.empty()) {
@@ -1,11 +1,15 @@
 #include "glview/preview/CSGTreeNormalizer.h"
 
+#include <algorithm>
 #include <cassert>
+#include <unordered_map>
 #include <utility>
 #include <memory>
 #include <stack>
+#include <vector>
 
 #include "core/CSGNode.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 
 // Helper function to debug normalization bugs
@@ -20,17 +24,190 @@ static bool validate_tree(const std::shared_ptr<CSGNode>& node)
 }
 #endif
 
+// Returns the number of leaves of a term whose children have been normalized
+static size_t countTerms(const CSGNode *node)
+{
+  if (!node) return 0;
+  const auto *op = dynamic_cast<const CSGOperation *>(node);
+  if (!op) return 1;
+  size_t terms = 0;
+  for (const CSGNode *child : {op->left().get(), op->right().get()}) {
+    if (const auto *childop = dynamic_cast<const CSGOperation *>(child)) {
+      terms += childop->normalized.state == CSGOperation::Normalized::State::NONE ? 1 : childop->normalized.terms;
+    } else if (child) {
+      terms += 1;
+    }
+  }
+  return terms;
+}
+
+// Looks up the memoized normalized form of a term. Returns false if it's not known.
+static bool lookupNormalized(std::shared_ptr<CSGNode>& node)
+{
+  const auto *op = dynamic_cast<const CSGOperation *>(node.get());
+  if (!op) return false;
+  switch (op->normalized.state) {
+  case CSGOperation::Normalized::State::SELF:
+    return true;
+  case CSGOperation::Normalized::State::REWRITTEN:
+    if (op->normalized.terms == 0) {
+      node.reset();
+      return true;
+    }
+    // The normalized term may have been released if it was rewritten by a later pass
+    if (auto term = op->normalized.term.lock()) {
+      node = term;
+      return true;
+    }
+    return false;
+  default:
+    return false;
+  }
+}
+
+// Memoizes the normalized form of a term, and returns its number of leaves
+static size_t memoizeNormalized(const std::shared_ptr<CSGNode>& origin, const std::shared_ptr<CSGNode>& result)
+{
+  using State = CSGOperation::Normalized::State;
+  const size_t terms = countTerms(result.get());
+  if (auto *op = dynamic_cast<CSGOperation *>(result.get())) {
+    op->normalized.state = State::SELF;
+    op->normalized.terms = terms;
+  }
+  if (origin != result) {
+    if (auto *op = dynamic_cast<CSGOperation *>(origin.get())) {
+      op->normalized.state = State::REWRITTEN;
+      op->normalized.term = result;
+      op->normalized.terms = terms;
+    }
+  }
+  return terms;
+}
+
+static bool isUnion(const std::shared_ptr<CSGNode>& node) {
+  std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node);
+  return op && op->getType() == OpenSCADOperator::UNION;
+}
+
+static bool hasRightNonLeaf(const std::shared_ptr<CSGNode>& node) {
+  std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node);
+  return op->right() && (std::dynamic_pointer_cast<CSGLeaf>(op->right()) == nullptr);
+}
+
+static bool hasLeftUnion(const std::shared_ptr<CSGNode>& node) {
+  std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node);
+  return op && isUnion(op->left());
+}
+
+// Returns true if any operation node is reachable from more than one of the given roots.
+// Sharing within a single root doesn't matter, as each root is normalized by one thread.
+static bool sharesSubtrees(const std::vector<std::shared_ptr<CSGNode>>& roots)
+{
+  std::unordered_map<const CSGNode *, size_t> owners;
+  std::vector<const CSGOperation *> stack;
+  for (size_t i = 0; i < roots.size(); ++i) {
+    if (const auto *op = dynamic_cast<const CSGOperation *>(roots[i].get())) stack.push_back(op);
+    while (!stack.empty()) {
+      const auto *op = stack.back();
+      stack.pop_back();
+      const auto [owner, inserted] = owners.emplace(op, i);
+      if (!inserted) {
+        if (owner->second != i) return true;
+        continue;
+      }
+      for (const CSGNode *child : {op->left().get(), op->right().get()}) {
+        if (const auto *childop = dynamic_cast<const CSGOperation *>(child)) stack.push_back(childop);
+      }
+    }
+  }
+  return false;
+}
+
 /*!
    NB! for e.g. empty intersections, this can normalize a tree to nothing and return nullptr.
+
+   Unions are never rewritten by the normalization, so the branches below the
+   top-level unions are normalized independently, in parallel if possible.
  */
 std::shared_ptr<CSGNode> CSGTreeNormalizer::normalize(const std::shared_ptr<CSGNode>& root)
 {
   this->aborted = false;
-  this->nodecount = 0;
-  std::shared_ptr<CSGNode> temp = root;
-  temp = normalizePass(temp);
-  this->rootnode.reset();
-  return temp;
+  this->termcount = 0;
+  this->independentbranches = 0;
+
+  if (!isUnion(root)) {
+    auto result = normalizeBranch(root);
+    if (this->aborted) {
+      LOG(message_group::Warning, "Normalized tree is growing past %1$d elements. Aborting normalization.\n", this->limit);
+      return {};
+    }
+    return result;
+  }
+
+  // Split the tree into the union operations at the top and the branches below them.
+  // For each union, remember where it's attached to its parent (nullptr for the root).
+  struct Slot {
+    std::shared_ptr<CSGOperation> op;
+    bool left;
+  };
+  std::vector<std::shared_ptr<CSGOperation>> unions{std::dynamic_pointer_cast<CSGOperation>(root)};
+  std::vector<Slot> unionslots{Slot{nullptr, false}};
+  std::vector<Slot> branchslots;
+  std::vector<std::shared_ptr<CSGNode>> branches;
+  for (size_t i = 0; i < unions.size(); ++i) {
+    const auto op = unions[i];
+    for (const bool left : {true, false}) {
+      const auto& child = left ? op->left() : op->right();
+      if (isUnion(child)) {
+        unions.push_back(std::dynamic_pointer_cast<CSGOperation>(child));
+        unionslots.push_back(Slot{op, left});
+      } else {
+        branches.push_back(child);
+        branchslots.push_back(Slot{op, left});
+      }
+    }
+  }
+
+  std::vector<std::shared_ptr<CSGNode>> results(branches.size());
+  const auto normalizeTerm = [this](const std::shared_ptr<CSGNode>& term) { return normalizeBranch(term); };
+  if (sharesSubtrees(branches)) {
+    // Terms are normalized in-place, so shared subtrees must be normalized by a single thread
+    std::transform(branches.begin(), branches.end(), results.begin(), normalizeTerm);
+  } else {
+    parallelizable_transform(branches.begin(), branches.end(), results.begin(), normalizeTerm);
+    this->independentbranches = branches.size();
+  }
+
+  if (this->aborted) {
+    LOG(message_group::Warning, "Normalized tree is growing past %1$d elements. Aborting normalization.\n", this->limit);
+    return {};
+  }
+
+  for (size_t i = 0; i < branches.size(); ++i) {
+    auto& slot = branchslots[i];
+    (slot.left ? slot.op->left() : slot.op->right()) = results[i];
+  }
+
+  // Collapse empty branches bottom-up
+  std::shared_ptr<CSGNode> result = root;
+  for (size_t i = unions.size(); i-- > 0;) {
+    auto node = collapse_null_terms(unions[i]);
+    if (node == unions[i]) continue;
+    auto& slot = unionslots[i];
+    if (slot.op) (slot.left ? slot.op->left() : slot.op->right()) = node;
+    else result = node;
+  }
+  return result;
+}
+
+std::shared_ptr<CSGNode> CSGTreeNormalizer::normalizeBranch(const std::shared_ptr<CSGNode>& term)
+{
+  if (this->aborted) return {};
+  auto result = normalizePass(term);
+  if (result && !this->aborted && (this->termcount += countTerms(result.get())) > this->limit) {
+    this->aborted = true;
+  }
+  return result;
 }
 
 /*!
@@ -49,21 +226,6 @@ std::shared_ptr<CSGNode> CSGTreeNormalizer::cleanup_term(std::shared_ptr<CSGNode
   return t;
 }
 
-static bool isUnion(const std::shared_ptr<CSGNode>& node) {
-  std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node);
-  return op && op->getType() == OpenSCADOperator::UNION;
-}
-
-static bool hasRightNonLeaf(const std::shared_ptr<CSGNode>& node) {
-  std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node);
-  return op->right() && (std::dynamic_pointer_cast<CSGLeaf>(op->right()) == nullptr);
-}
-
-static bool hasLeftUnion(const std::shared_ptr<CSGNode>& node) {
-  std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node);
-  return op && isUnion(op->left());
-}
-
 std::shared_ptr<CSGNode> CSGTreeNormalizer::normalizePass(std::shared_ptr<CSGNode> node)
 {
   // This function implements the CSG normalization
@@ -81,21 +243,24 @@ std::shared_ptr<CSGNode> CSGTreeNormalizer::normalizePass(std::shared_ptr<CSGNod
   // See Issue #2883 for problem with previous iterative implementation
   // See Pull Request #2343 for the initial reasons for making this not recursive.
 
-  // stores current node and bool indicating if it was a left or right call;
-  using stackframe_t = std::pair<std::shared_ptr<CSGOperation>, bool>;
+  // Subtrees which were already normalized are looked up in their memo
+  // instead of being traversed again.
+
+  // stores current node, bool indicating if it was a left or right call,
+  // and the child node before normalization (for memoization)
+  struct stackframe_t {
+    std::shared_ptr<CSGOperation> op;
+    bool left;
+    std::shared_ptr<CSGNode> origin;
+  };
   std::stack<stackframe_t> callstack;
 
 entrypoint:
   if (std::dynamic_pointer_cast<CSGLeaf>(node)) goto return_node;
+  if (lookupNormalized(node)) goto return_node;
   do {
     while (node && match_and_replace(node)) {
     }
-    this->nodecount++;
-    if (nodecount > this->limit) {
-      LOG(message_group::Warning, "Normalized tree is growing past %1$d elements. Aborting normalization.\n", this->limit);
-      this->aborted = true;
-      return {};
-    }
     if (!node || std::dynamic_pointer_cast<CSGLeaf>(node)) goto return_node;
     goto normalize_left_if_op;
 cont_left:;
@@ -119,19 +284,23 @@ return_node:
   } else {
     stackframe_t frame = callstack.top();
     callstack.pop();
-    if (frame.second) { // came from a left call
-      frame.first->left() = node;
-      node = frame.first;
+    if (!this->aborted && memoizeNormalized(frame.origin, node) + this->termcount > this->limit) {
+      this->aborted = true;
+      return {};
+    }
+    if (frame.left) { // came from a left call
+      frame.op->left() = node;
+      node = frame.op;
       goto cont_left;
     } else { // came from a right call
-      frame.first->right() = node;
-      node = frame.first;
+      frame.op->right() = node;
+      node = frame.op;
       goto cont_right;
     }
   }
 normalize_left_if_op:
   if (std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node)) {
-    callstack.emplace(op, true);
+    callstack.push({op, true, op->left()});
     node = op->left();
     goto entrypoint;
   }
@@ -139,7 +308,7 @@ normalize_left_if_op:
 normalize_right:
   std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node);
   assert(op);
-  callstack.emplace(op, false);
+  callstack.push({op, false, op->right()});
   node = op->right();
   goto entrypoint;
 }
@@ -149,12 +318,10 @@ std::shared_ptr<CSGNode> CSGTreeNormalizer::collapse_null_terms(const std::share
   std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node);
   if (op) {
     if (!op->right()) {
-      this->nodecount--;
       if (op->getType() == OpenSCADOperator::UNION || op->getType() == OpenSCADOperator::DIFFERENCE) return op->left();
       else return op->right();
     }
     if (!op->left()) {
-      this->nodecount--;
       if (op->getType() == OpenSCADOperator::UNION) return op->right();
       else return op->left();
     }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
 
@@ -9,16 +10,22 @@ public:
   CSGTreeNormalizer(size_t limit) : limit(limit) {}
 
   std::shared_ptr<class CSGNode> normalize(const std::shared_ptr<CSGNode>& term);
+  // Number of terms (leaves) in the last normalized tree, which is what the limit applies to
+  [[nodiscard]] size_t getTermCount() const { return this->termcount; }
+  // Number of union branches in the last normalized tree which shared no subtrees and were
+  // therefore normalized independently (in parallel where supported), 0 if there were none
+  [[nodiscard]] size_t getIndependentBranches() const { return this->independentbranches; }
 
 private:
+  std::shared_ptr<CSGNode> normalizeBranch(const std::shared_ptr<CSGNode>& term);
   std::shared_ptr<CSGNode> normalizePass(std::shared_ptr<CSGNode> term);
   bool match_and_replace(std::shared_ptr<class CSGNode>& term);
   std::shared_ptr<CSGNode> collapse_null_terms(const std::shared_ptr<CSGNode>& term);
   std::shared_ptr<CSGNode> cleanup_term(std::shared_ptr<CSGNode>& t);
   [[nodiscard]] unsigned int count(const std::shared_ptr<CSGNode>& term) const;
 
-  bool aborted{false};
+  std::atomic<bool> aborted{false};
   size_t limit;
-  size_t nodecount{0};
-  std::shared_ptr<class CSGNode> rootnode;
+  std::atomic<size_t> termcount{0};
+  size_t independentbranches{0};
 };
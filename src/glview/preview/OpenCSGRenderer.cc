@@ -27,6 +27,7 @@
 #include "glview/preview/OpenCSGRenderer.h"
 #include "glview/Renderer.h"
 #include "glview/VertexState.h"
+#include "glview/VBOInstancePlan.h"
 #include "geometry/linalg.h"
 #include "glview/system-gl.h"
 
@@ -35,6 +36,7 @@
 #include <memory>
 #include <memory.h>
 #include <cstddef>
+#include <iterator>
 #include <utility>
 #include <vector>
 
@@ -71,6 +73,7 @@ OpenCSGVBOPrim *createVBOPrimitive(
       vertex_state->drawType(), vertex_state->drawOffset(),
       vertex_state->elementOffset(), vertex_state->verticesVBO(),
       vertex_state->elementsVBO());
+  opencsg_vs->setModelMatrix(vertex_state->modelMatrix());
   // First two glBegin entries are the vertex position calls
   opencsg_vs->glBegin().insert(opencsg_vs->glBegin().begin(),
                                vertex_state->glBegin().begin(),
@@ -83,6 +86,15 @@ OpenCSGVBOPrim *createVBOPrimitive(
   return new OpenCSGVBOPrim(operation, convexity, std::move(opencsg_vs));
 }
 
+Transform3d subtractionMatrix(const CSGChainObject& csgobj) {
+  Transform3d tmp = csgobj.leaf->matrix;
+  if (csgobj.leaf->polyset->getDimension() == 2) {
+    // Scale 2D negative objects 10% in the Z direction to avoid z fighting
+    tmp *= Eigen::Scaling(1.0, 1.0, 1.1);
+  }
+  return tmp;
+}
+
 }  // namespace
 
 #endif // ENABLE_OPENCSG
@@ -96,7 +108,12 @@ OpenCSGRenderer::OpenCSGRenderer(
       background_products_(std::move(background_products)) {}
 
 void OpenCSGRenderer::prepare(const ShaderUtils::ShaderInfo *shaderinfo) {
-  if (vertex_state_containers_.empty()) {
+  if (lodChanged()) {
+    vbo_products_.clear(); // Mark as dirty
+    vertex_state_containers_.clear();
+  }
+  if (vbo_products_.empty()) {
+    beginLOD();
     if (root_products_) {
       createCSGVBOProducts(*root_products_, false, false, shaderinfo);
     }
@@ -116,7 +133,7 @@ void OpenCSGRenderer::draw(bool showedges, const ShaderUtils::ShaderInfo *shader
     shaderinfo->type == ShaderUtils::ShaderType::EDGE_RENDERING && showedges || 
     shaderinfo->type == ShaderUtils::ShaderType::SELECT_RENDERING);
 
-  for (const auto& product : vertex_state_containers_) {
+  for (const auto& product : vbo_products_) {
     if (product->primitives().size() > 1) {
       GL_CHECKD(OpenCSG::render(product->primitives()));
       GL_TRACE0("glDepthFunc(GL_EQUAL)");
@@ -161,43 +178,60 @@ void OpenCSGRenderer::draw(bool showedges, const ShaderUtils::ShaderInfo *shader
 }
 
 // Turn the CSGProducts into VBOs
-// Will create one (temporary) VertexArray and one VBO(+EBO) per product
-// The VBO will be utilized to render multiple objects with correct state
-// management. In the future, we could use a VBO per primitive and potentially
-// reuse VBOs, but that requires some more careful state management.
+// Will create one (temporary) VertexArray and one VBO(+EBO) shared by all
+// products, so a PolySet used by leaves of several products (e.g. a union of
+// repeated parts, which normalizes into one product per part) can be
+// instanced across them. Each product gets its own vertex states and
+// OpenCSG primitives drawing from that VBO.
 // Note: This function can be called multiple times for different products.
-// Each call will add to vbo_vertex_products_.
+// Each call will add to vbo_products_.
 void OpenCSGRenderer::createCSGVBOProducts(
     const CSGProducts &products, bool highlight_mode, bool background_mode, const ShaderUtils::ShaderInfo *shaderinfo) {
 #ifdef ENABLE_OPENCSG
   bool enable_barycentric = true;
+  VertexStateContainer& vertex_state_container = vertex_state_containers_.emplace_back();
+  auto& vertex_states = vertex_state_container.states();
+  VBOBuilder vbo_builder(std::make_unique<OpenCSGVertexStateFactory>(), vertex_state_container);
+  vbo_builder.addSurfaceData();
+  vbo_builder.writeSurface();
+  vbo_builder.addShaderData(); // Always enable barycentric coordinates
+
+  VBOInstancePlan instance_plan;
   for (const auto& product : products.products) {
-    std::unique_ptr<OpenCSGVBOProduct> vertex_state_container = std::make_unique<OpenCSGVBOProduct>();
- 
-    Color4f last_color;
-    std::vector<OpenCSG::Primitive *>& primitives = vertex_state_container->primitives();
-    auto& vertex_states = vertex_state_container->states();
-    VBOBuilder vbo_builder(std::make_unique<OpenCSGVertexStateFactory>(), *vertex_state_container.get());
-    vbo_builder.addSurfaceData();
-    vbo_builder.writeSurface();
-    vbo_builder.addShaderData(); // Always enable barycentric coordinates
-
-    size_t num_vertices = 0;
     for (const auto &csgobj : product.intersections) {
       if (csgobj.leaf->polyset) {
-        num_vertices += calcNumVertices(csgobj);
+        const auto polyset = lodPolySet(csgobj.leaf->polyset, csgobj.leaf->matrix);
+        instance_plan.add(*polyset, csgobj.leaf->matrix, calcNumVertices(*polyset));
       }
     }
     for (const auto &csgobj : product.subtractions) {
       if (csgobj.leaf->polyset) {
-        num_vertices += calcNumVertices(csgobj);
+        const auto polyset = lodPolySet(csgobj.leaf->polyset, csgobj.leaf->matrix);
+        instance_plan.add(*polyset, subtractionMatrix(csgobj), calcNumVertices(*polyset));
       }
     }
+  }
 
-    vbo_builder.allocateBuffers(num_vertices);
+  if (Feature::ExperimentalVxORenderersInstancing.is_enabled()) {
+    vbo_builder.setInstancePlan(&instance_plan);
+    vbo_builder.allocateBuffers(instance_plan.numVertices());
+  } else {
+    vbo_builder.allocateBuffers(instance_plan.numVerticesUnshared());
+  }
+
+  // The builder appends every state to the shared container. Remember where
+  // each product's states start, and hand them over once the VBO is complete.
+  std::vector<size_t> first_states;
+  for (const auto& product : products.products) {
+    first_states.push_back(vertex_states.size());
+    auto& vbo_product = vbo_products_.emplace_back(std::make_unique<OpenCSGVBOProduct>());
+
+    Color4f last_color;
+    std::vector<OpenCSG::Primitive *>& primitives = vbo_product->primitives();
 
     for (const auto &csgobj : product.intersections) {
       if (csgobj.leaf->polyset) {
+        const auto polyset = lodPolySet(csgobj.leaf->polyset, csgobj.leaf->matrix);
         const Color4f &c = csgobj.leaf->color;
         const auto csgmode = RendererUtils::getCsgMode(highlight_mode, background_mode);
 
@@ -219,18 +253,19 @@ void OpenCSGRenderer::createCSGVBOProducts(
           last_color = color;
         }
 
-        add_shader_pointers(vbo_builder, shaderinfo);
+        add_shader_pointers(vbo_builder, shaderinfo,
+                            vbo_builder.surfaceOffset(*polyset, csgobj.leaf->matrix));
 
         if (color[3] == 1.0f) {
           // object is opaque, draw normally
-          vbo_builder.create_surface(*csgobj.leaf->polyset, 
+          vbo_builder.create_surface(*polyset, 
                          csgobj.leaf->matrix, last_color, enable_barycentric, override_color);
           if (const auto csg_vs = std::dynamic_pointer_cast<OpenCSGVertexState>(
             vertex_states.back())) {
             csg_vs->setCsgObjectIndex(csgobj.leaf->index);
             primitives.emplace_back(
                 createVBOPrimitive(csg_vs, OpenCSG::Intersection,
-                                   csgobj.leaf->polyset->getConvexity()));
+                                   polyset->getConvexity()));
           }
         } else {
           // object is transparent, so draw rear faces first.  Issue #1496
@@ -241,7 +276,7 @@ void OpenCSGRenderer::createCSGVBOProducts(
           });
           vertex_states.emplace_back(std::move(cull));
 
-          vbo_builder.create_surface(*csgobj.leaf->polyset, 
+          vbo_builder.create_surface(*polyset, 
                          csgobj.leaf->matrix, last_color, enable_barycentric, override_color);
           if (const auto csg_vs = std::dynamic_pointer_cast<OpenCSGVertexState>(
                   vertex_states.back())) {
@@ -249,7 +284,7 @@ void OpenCSGRenderer::createCSGVBOProducts(
 
             primitives.emplace_back(
                 createVBOPrimitive(csg_vs, OpenCSG::Intersection,
-                                   csgobj.leaf->polyset->getConvexity()));
+                                   polyset->getConvexity()));
 
             cull = std::make_shared<VertexState>();
             cull->glBegin().emplace_back([]() {
@@ -275,6 +310,7 @@ void OpenCSGRenderer::createCSGVBOProducts(
 
     for (const auto &csgobj : product.subtractions) {
       if (csgobj.leaf->polyset) {
+        const auto polyset = lodPolySet(csgobj.leaf->polyset, csgobj.leaf->matrix);
         const Color4f &c = csgobj.leaf->color;
         const auto csgmode = RendererUtils::getCsgMode(highlight_mode, background_mode,
                                          OpenSCADOperator::DIFFERENCE);
@@ -297,7 +333,8 @@ void OpenCSGRenderer::createCSGVBOProducts(
           last_color = color;
         }
 
-        add_shader_pointers(vbo_builder, shaderinfo);
+        const Transform3d tmp = subtractionMatrix(csgobj);
+        add_shader_pointers(vbo_builder, shaderinfo, vbo_builder.surfaceOffset(*polyset, tmp));
 
         // negative objects should only render rear faces
         std::shared_ptr<VertexState> cull = std::make_shared<VertexState>();
@@ -310,19 +347,14 @@ void OpenCSGRenderer::createCSGVBOProducts(
           GL_CHECKD(glCullFace(GL_FRONT));
         });
         vertex_states.emplace_back(std::move(cull));
-        Transform3d tmp = csgobj.leaf->matrix;
-        if (csgobj.leaf->polyset->getDimension() == 2) {
-          // Scale 2D negative objects 10% in the Z direction to avoid z fighting
-          tmp *= Eigen::Scaling(1.0, 1.0, 1.1);
-        }
-        vbo_builder.create_surface(*csgobj.leaf->polyset, tmp,
+        vbo_builder.create_surface(*polyset, tmp,
                        last_color, enable_barycentric, override_color);
         if (const auto csg_vs = std::dynamic_pointer_cast<OpenCSGVertexState>(
           vertex_states.back())) {
           csg_vs->setCsgObjectIndex(csgobj.leaf->index);
           primitives.emplace_back(
               createVBOPrimitive(csg_vs, OpenCSG::Subtraction,
-                                 csgobj.leaf->polyset->getConvexity()));
+                                 polyset->getConvexity()));
         } else {
           assert(false && "Subtraction surface state was nullptr");
         }
@@ -335,18 +367,24 @@ void OpenCSGRenderer::createCSGVBOProducts(
         vertex_states.emplace_back(std::move(cull));
       }
     }
+  }
 
-    if (Feature::ExperimentalVxORenderersIndexing.is_enabled()) {
-      GL_TRACE0("glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0)");
-      GL_CHECKD(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
-    }
-    GL_TRACE0("glBindBuffer(GL_ARRAY_BUFFER, 0)");
-    GL_CHECKD(glBindBuffer(GL_ARRAY_BUFFER, 0));
+  if (Feature::ExperimentalVxORenderersIndexing.is_enabled()) {
+    GL_TRACE0("glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0)");
+    GL_CHECKD(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+  }
+  GL_TRACE0("glBindBuffer(GL_ARRAY_BUFFER, 0)");
+  GL_CHECKD(glBindBuffer(GL_ARRAY_BUFFER, 0));
 
-    vbo_builder.createInterleavedVBOs();
-    vertex_state_containers_.push_back(std::move(vertex_state_container));
+  vbo_builder.createInterleavedVBOs();
 
+  const size_t first_product = vbo_products_.size() - first_states.size();
+  for (size_t i = 0; i < first_states.size(); ++i) {
+    const auto begin = vertex_states.begin() + first_states[i];
+    const auto end = i + 1 < first_states.size() ? vertex_states.begin() + first_states[i + 1] : vertex_states.end();
+    vbo_products_[first_product + i]->states().assign(std::make_move_iterator(begin), std::make_move_iterator(end));
   }
+  vertex_states.clear();
 #endif // ENABLE_OPENCSG
 }
 
@@ -45,7 +45,7 @@ public:
   }
 };
 
-class OpenCSGVBOProduct : public VertexStateContainer
+class OpenCSGVBOProduct
 {
 public:
   OpenCSGVBOProduct() = default;
@@ -54,12 +54,15 @@ public:
   virtual ~OpenCSGVBOProduct() = default;
 
   [[nodiscard]] std::vector<OpenCSG::Primitive *>& primitives() { return primitives_; }
+  std::vector<std::shared_ptr<VertexState>>& states() { return states_; }
+  const std::vector<std::shared_ptr<VertexState>>& states() const { return states_; }
 
 private:
   // primitives_ is used to create the OpenCSG depth buffer (unlit rendering).
   // states_ is used for color rendering (using GL_EQUAL).
-  // Both may use the same underlying VBOs
+  // Both use the VBOs shared by all products of a CSGProducts
   std::vector<OpenCSG::Primitive *> primitives_;
+  std::vector<std::shared_ptr<VertexState>> states_;
 };
 
 class OpenCSGRenderer : public VBORenderer
@@ -76,7 +79,9 @@ public:
 private:
   void createCSGVBOProducts(const CSGProducts& products, bool highlight_mode, bool background_mode, const ShaderUtils::ShaderInfo *shaderinfo);
 
-  std::vector<std::unique_ptr<OpenCSGVBOProduct>> vertex_state_containers_;
+  // Owners of the VBOs, one per CSGProducts
+  std::vector<VertexStateContainer> vertex_state_containers_;
+  std::vector<std::unique_ptr<OpenCSGVBOProduct>> vbo_products_;
   std::shared_ptr<CSGProducts> root_products_;
   std::shared_ptr<CSGProducts> highlights_products_;
   std::shared_ptr<CSGProducts> background_products_;
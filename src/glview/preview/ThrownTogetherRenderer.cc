@@ -32,6 +32,7 @@
 #include "geometry/linalg.h"
 #include "Feature.h"
 #include "glview/VertexState.h"
+#include "glview/VBOInstancePlan.h"
 #include "geometry/PolySet.h"
 #include "core/enums.h"
 #include "utils/printutils.h"
@@ -69,6 +70,15 @@ Renderer::ColorMode getColorMode(const CSGNode::Flag& flags, bool highlight_mode
   return colormode;
 }
 
+Transform3d surfaceMatrix(const CSGChainObject& csgobj, OpenSCADOperator type) {
+  Transform3d mat = csgobj.leaf->matrix;
+  if (csgobj.leaf->polyset->getDimension() == 2 && type == OpenSCADOperator::DIFFERENCE) {
+    // Scale 2D negative objects 10% in the Z direction to avoid z fighting
+    mat *= Eigen::Scaling(1.0, 1.0, 1.1);
+  }
+  return mat;
+}
+
 }  // namespace
 
 ThrownTogetherRenderer::ThrownTogetherRenderer(std::shared_ptr<CSGProducts> root_products,
@@ -85,19 +95,28 @@ ThrownTogetherRenderer::~ThrownTogetherRenderer()
 void ThrownTogetherRenderer::prepare(const ShaderUtils::ShaderInfo *shaderinfo)
 {
   PRINTD("Thrown prepare");
-  if (vertex_state_containers_.empty()) {   
+  if (lodChanged()) {
+    vertex_state_containers_.clear(); // Mark as dirty
+  }
+  if (vertex_state_containers_.empty()) {
+    beginLOD();
     VertexStateContainer &vertex_state_container = vertex_state_containers_.emplace_back();
 
     VBOBuilder vbo_builder(std::make_unique<TTRVertexStateFactory>(), vertex_state_container);
     vbo_builder.addSurfaceData();
     vbo_builder.addShaderData(); // Always enable barycentric coordinates
 
-    size_t num_vertices = 0;
-    if (this->root_products_) num_vertices += (calcNumVertices(this->root_products_, true) * 2);
-    if (this->background_products_) num_vertices += calcNumVertices(this->background_products_, true);
-    if (this->highlight_products_) num_vertices += calcNumVertices(this->highlight_products_, true);
+    VBOInstancePlan instance_plan;
+    if (this->root_products_) planCSGProducts(*this->root_products_, instance_plan, false, false);
+    if (this->background_products_) planCSGProducts(*this->background_products_, instance_plan, false, true);
+    if (this->highlight_products_) planCSGProducts(*this->highlight_products_, instance_plan, true, false);
 
-    vbo_builder.allocateBuffers(num_vertices);
+    if (Feature::ExperimentalVxORenderersInstancing.is_enabled()) {
+      vbo_builder.setInstancePlan(&instance_plan);
+      vbo_builder.allocateBuffers(instance_plan.numVertices());
+    } else {
+      vbo_builder.allocateBuffers(instance_plan.numVerticesUnshared());
+    }
 
     if (this->root_products_) createCSGProducts(*this->root_products_, vertex_state_container, vbo_builder, false, false, shaderinfo);
     if (this->background_products_) createCSGProducts(*this->background_products_, vertex_state_container, vbo_builder, false, true, shaderinfo);
@@ -160,6 +179,7 @@ void ThrownTogetherRenderer::createChainObject(VertexStateContainer& container,
     return;
   }
 
+  const auto polyset = lodPolySet(csgobj.leaf->polyset, csgobj.leaf->matrix);
   bool enable_barycentric = true;
 
   const auto& leaf_color = csgobj.leaf->color;
@@ -172,9 +192,10 @@ void ThrownTogetherRenderer::createChainObject(VertexStateContainer& container,
     const ColorMode colormode = getColorMode(csgobj.flags, highlight_mode, background_mode, false, type);
     getShaderColor(colormode, leaf_color, color);
 
-    add_shader_pointers(vbo_builder, shaderinfo);
+    add_shader_pointers(vbo_builder, shaderinfo,
+                        vbo_builder.surfaceOffset(*polyset, csgobj.leaf->matrix));
 
-    vbo_builder.create_surface(*csgobj.leaf->polyset, csgobj.leaf->matrix, color, enable_barycentric);
+    vbo_builder.create_surface(*polyset, csgobj.leaf->matrix, color, enable_barycentric);
     if (const auto ttr_vs = std::dynamic_pointer_cast<TTRVertexState>(vbo_builder.states().back())) {
       ttr_vs->setCsgObjectIndex(csgobj.leaf->index);
     }
@@ -182,7 +203,8 @@ void ThrownTogetherRenderer::createChainObject(VertexStateContainer& container,
     ColorMode colormode = getColorMode(csgobj.flags, highlight_mode, background_mode, false, type);
     getShaderColor(colormode, leaf_color, color);
 
-    add_shader_pointers(vbo_builder, shaderinfo);
+    const Transform3d mat = surfaceMatrix(csgobj, type);
+    add_shader_pointers(vbo_builder, shaderinfo, vbo_builder.surfaceOffset(*polyset, mat));
 
     auto cull = std::make_shared<VertexState>();
     cull->glBegin().emplace_back([]() {
@@ -193,12 +215,7 @@ void ThrownTogetherRenderer::createChainObject(VertexStateContainer& container,
     });
     container.states().emplace_back(std::move(cull));
 
-    Transform3d mat = csgobj.leaf->matrix;
-    if (csgobj.leaf->polyset->getDimension() == 2 && type == OpenSCADOperator::DIFFERENCE) {
-      // Scale 2D negative objects 10% in the Z direction to avoid z fighting
-      mat *= Eigen::Scaling(1.0, 1.0, 1.1);
-    }
-    vbo_builder.create_surface(*csgobj.leaf->polyset, mat, color, enable_barycentric);
+    vbo_builder.create_surface(*polyset, mat, color, enable_barycentric);
     if (auto ttr_vs = std::dynamic_pointer_cast<TTRVertexState>(vbo_builder.states().back())) {
       ttr_vs->setCsgObjectIndex(csgobj.leaf->index);
     }
@@ -208,7 +225,8 @@ void ThrownTogetherRenderer::createChainObject(VertexStateContainer& container,
     colormode = getColorMode(csgobj.flags, highlight_mode, background_mode, true, type);
     getShaderColor(colormode, leaf_color, color);
 
-    add_shader_pointers(vbo_builder, shaderinfo);
+    add_shader_pointers(vbo_builder, shaderinfo,
+                        vbo_builder.surfaceOffset(*polyset, csgobj.leaf->matrix));
 
     cull = std::make_shared<VertexState>();
     cull->glBegin().emplace_back([]() {
@@ -217,7 +235,7 @@ void ThrownTogetherRenderer::createChainObject(VertexStateContainer& container,
     });
     container.states().emplace_back(std::move(cull));
 
-    vbo_builder.create_surface(*csgobj.leaf->polyset, csgobj.leaf->matrix, color, enable_barycentric);
+    vbo_builder.create_surface(*polyset, csgobj.leaf->matrix, color, enable_barycentric);
     if (auto ttr_vs = std::dynamic_pointer_cast<TTRVertexState>(vbo_builder.states().back())) {
       ttr_vs->setCsgObjectIndex(csgobj.leaf->index);
     }
@@ -229,6 +247,37 @@ void ThrownTogetherRenderer::createChainObject(VertexStateContainer& container,
   }
 }
 
+// Registers the surfaces createCSGProducts() will create, so the VBO can be
+// sized and surfaces shared between leaves detected before anything is written.
+void ThrownTogetherRenderer::planCSGProducts(const CSGProducts& products, VBOInstancePlan& instance_plan,
+                                             bool highlight_mode, bool background_mode) const
+{
+  this->geom_visit_mark_.clear();
+
+  const auto plan_object = [&](const CSGChainObject& csgobj, OpenSCADOperator type) {
+    if (!csgobj.leaf->polyset ||
+        this->geom_visit_mark_[std::make_pair(csgobj.leaf->polyset.get(), &csgobj.leaf->matrix)]++ > 0) {
+      return;
+    }
+    const auto polyset = lodPolySet(csgobj.leaf->polyset, csgobj.leaf->matrix);
+    const auto num_vertices = calcNumVertices(*polyset);
+    if (!highlight_mode && !background_mode) {
+      // root mode draws the object twice, see createChainObject()
+      instance_plan.add(*polyset, surfaceMatrix(csgobj, type), num_vertices);
+    }
+    instance_plan.add(*polyset, csgobj.leaf->matrix, num_vertices);
+  };
+
+  for (const auto& product : products.products) {
+    for (const auto& csgobj : product.intersections) {
+      plan_object(csgobj, OpenSCADOperator::INTERSECTION);
+    }
+    for (const auto& csgobj : product.subtractions) {
+      plan_object(csgobj, OpenSCADOperator::DIFFERENCE);
+    }
+  }
+}
+
 void ThrownTogetherRenderer::createCSGProducts(const CSGProducts& products, VertexStateContainer& container, VBOBuilder& vbo_builder,
                                                bool highlight_mode, bool background_mode, const ShaderUtils::ShaderInfo *shaderinfo)
 {
@@ -13,6 +13,7 @@
 
 class CSGProducts;
 class CSGChainObject;
+class VBOInstancePlan;
 
 class TTRVertexState : public VertexState
 {
@@ -61,6 +62,8 @@ private:
                          bool highlight_mode = false, bool background_mode = false,
                          bool fberror = false) const;
 
+  void planCSGProducts(const CSGProducts& products, VBOInstancePlan& instance_plan,
+                       bool highlight_mode, bool background_mode) const;
   void createCSGProducts(const CSGProducts& products, VertexStateContainer& container, VBOBuilder& vbo_builder,
                          bool highlight_mode, bool background_mode, const ShaderUtils::ShaderInfo *shaderinfo);
   void createChainObject(VertexStateContainer& container, VBOBuilder& vbo_builder, const CSGChainObject& csgobj,
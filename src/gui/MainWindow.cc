@@ -1383,12 +1383,13 @@ void MainWindow::compileCSG()
     LOG("Compiling design (CSG Products normalization)...");
     this->processEvents();
 
-    size_t normalizelimit = 2ul * Preferences::inst()->getValue("advanced/openCSGLimit").toUInt();
+    size_t normalizelimit = Preferences::inst()->getValue("advanced/openCSGLimit").toUInt();
     CSGTreeNormalizer normalizer(normalizelimit);
 
     if (this->csgRoot) {
       this->normalizedRoot = normalizer.normalize(this->csgRoot);
       if (this->normalizedRoot) {
+        LOG("Normalized CSG tree has %1$d terms", normalizer.getTermCount());
         this->rootProduct.reset(new CSGProducts());
         this->rootProduct->import(this->normalizedRoot);
       } else {
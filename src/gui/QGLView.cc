@@ -27,6 +27,7 @@
 #include "gui/QGLView.h"
 
 #include "geometry/linalg.h"
+#include "geometry/LODCache.h"
 #include "gui/qtgettext.h"
 #include "gui/Preferences.h"
 #include "glview/Renderer.h"
@@ -75,6 +76,7 @@ QGLView::QGLView(QWidget *parent) : QOpenGLWidget(parent)
 QGLView::~QGLView()
 {
   std::cout << "QGLView::~QGLView()" << std::endl;
+  LODCache::instance()->removeReadyHandler(this);
   // Just to make sure we can call GL functions in the supertype destructor
   makeCurrent();
 }
@@ -82,6 +84,11 @@ QGLView::~QGLView()
 void QGLView::init()
 {
   resetView();
+  setLevelOfDetail(true);
+  // Levels are computed in the background, so repaint when one is ready
+  LODCache::instance()->addReadyHandler(this, [this]() {
+    QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection);
+  });
 
   this->mouse_drag_active = false;
   this->statusLabel = nullptr;
@@ -24,10 +24,14 @@
  *
  */
 
+#include <cstddef>
 #include <exception>
+#include <map>
+#include <optional>
 #include <utility>
 #include <fstream>
 #include <string>
+#include <vector>
 #include "json/json.hpp"
 
 #include "core/AST.h"
@@ -39,48 +43,106 @@ using json = nlohmann::json;
 
 namespace {
 
-ObjectType to_obj(const json& j, EvaluationSession *session);
-
-Value to_value(const json& j, EvaluationSession *session)
+/*
+ * Builds Values directly from the events of the JSON parser, instead of
+ * parsing into a json document first and converting that, so the data
+ * is only held once. Objects get their members in the order (sorted by
+ * key, last duplicate wins) they'd have in a json document.
+ */
+class ValueBuilder : public nlohmann::json_sax<json>
 {
-  if (j.is_string()) {
-    return Value{j.get<std::string>()};
-  } else if (j.is_number()) {
-    return Value{j.get<double>()};
-  } else if (j.is_boolean()) {
-    return Value{j.get<bool>()};
-  } else if (j.is_object()) {
-    return Value{to_obj(j, session)};
-  } else if (j.is_array()) {
-    Value::VectorType vec{session};
-    for (const auto& elem : j) {
-      vec.emplace_back(to_value(elem, session));
+public:
+  ValueBuilder(EvaluationSession *session) : session(session) {}
+
+  bool null() override { return add(Value::undefined.clone()); }
+  bool boolean(bool val) override { return add(Value{val}); }
+  bool number_integer(number_integer_t val) override { return add(Value{static_cast<double>(val)}); }
+  bool number_unsigned(number_unsigned_t val) override { return add(Value{static_cast<double>(val)}); }
+  bool number_float(number_float_t val, const string_t& /*s*/) override { return add(Value{val}); }
+  bool string(string_t& val) override { return add(Value{std::move(val)}); }
+  bool binary(binary_t& /*val*/) override { return add(Value::undefined.clone()); }
+
+  bool start_object(std::size_t /*elements*/) override {
+    push().is_object = true;
+    return true;
+  }
+  bool key(string_t& val) override {
+    frames[depth - 1].key = std::move(val);
+    return true;
+  }
+  bool end_object() override {
+    Frame& frame = frames[--depth];
+    ObjectType obj{session};
+    for (auto& member : frame.members) {
+      obj.set(member.first, std::move(member.second));
     }
-    return std::move(vec);
+    frame.members.clear();
+    return add(Value{std::move(obj)});
   }
-  return Value::undefined.clone();
-}
 
-ObjectType to_obj(const json& j, EvaluationSession *session)
-{
-  ObjectType obj{session};
-  for (const auto& item : j.items()) {
-    obj.set(item.key(), to_value(item.value(), session));
+  bool start_array(std::size_t /*elements*/) override {
+    Frame& frame = push();
+    frame.is_object = false;
+    frame.elements.emplace(session);
+    return true;
   }
-  return obj;
-}
+  bool end_array() override {
+    Frame& frame = frames[--depth];
+    Value vec{std::move(*frame.elements)};
+    frame.elements.reset();
+    return add(std::move(vec));
+  }
+
+  bool parse_error(std::size_t /*position*/, const std::string& /*last_token*/, const nlohmann::detail::exception& ex) override {
+    throw ex;
+  }
+
+  Value result = Value::undefined.clone();
+
+private:
+  // An array or object being parsed. Array elements are appended to the
+  // resulting vector directly. Frames are reused for the following arrays
+  // and objects at the same depth.
+  struct Frame {
+    bool is_object = false;
+    std::optional<Value::VectorType> elements;
+    std::map<std::string, Value> members;
+    std::string key; // of the next member
+  };
+
+  Frame& push() {
+    if (frames.size() == depth) frames.emplace_back();
+    return frames[depth++];
+  }
+
+  bool add(Value&& value) {
+    if (depth == 0) {
+      result = std::move(value);
+    } else if (Frame& frame = frames[depth - 1]; frame.is_object) {
+      frame.members.insert_or_assign(std::move(frame.key), std::move(value));
+    } else {
+      frame.elements->emplace_back(std::move(value));
+    }
+    return true;
+  }
+
+  EvaluationSession *session;
+  std::vector<Frame> frames;
+  size_t depth = 0;
+};
 
 } // namespace
 
 Value import_json(const std::string& filename, EvaluationSession *session, const Location& loc)
 {
-  std::ifstream i(filename);
+  std::ifstream i(filename, std::ios::binary);
 
   try {
     if (i) {
-      json j;
-      i >> j;
-      return Value{to_value(j, session)};
+      // Not strict, like reading a json document from a stream, which ignores trailing input
+      ValueBuilder builder(session);
+      json::sax_parse(i, &builder, json::input_format_t::json, false);
+      return std::move(builder.result);
     } else {
       LOG(message_group::Warning, loc, "", "Could not read file '%1$s'", filename);
     }
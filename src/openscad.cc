@@ -64,6 +64,7 @@
 
 #include "core/Builtins.h"
 #include "core/CSGTreeEvaluator.h"
+#include "core/CSGTreeOptimizer.h"
 #include "core/customizer/CommentParser.h"
 #include "core/customizer/ParameterObject.h"
 #include "core/customizer/ParameterSet.h"
@@ -436,7 +437,7 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
   fs::current_path(cmd.original_path);
 
   // Do we have an explicit root node (! modifier)?
-  std::shared_ptr<const AbstractNode> root_node;
+  std::shared_ptr<AbstractNode> root_node;
   const Location *nextLocation = nullptr;
   if (!(root_node = find_root_tag(absolute_root_node, &nextLocation))) {
     root_node = absolute_root_node;
@@ -478,10 +479,17 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
       }
     });
   } else if (export_format == FileFormat::ECHO) {
-    // echo -> don't need to evaluate any geometry
+    // echo -> don't need to evaluate any geometry, but evaluation statistics may be requested
+    if (!cmd.summaryOptions.empty()) {
+      RenderStatistic renderStatistic;
+      renderStatistic.setEvaluationSession(&session);
+      renderStatistic.printAll(nullptr, camera, cmd.summaryOptions, cmd.summaryFile);
+    }
   } else {
     // start measuring render time
     RenderStatistic renderStatistic;
+    renderStatistic.setEvaluationSession(&session);
+    CSGTreeOptimizer treeOptimizer;
     GeometryEvaluator geomevaluator(tree);
     std::unique_ptr<OffscreenView> glview;
     std::shared_ptr<const Geometry> root_geom;
@@ -493,6 +501,11 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
       // Force creation of concrete geometry (mostly for testing)
       // FIXME: Consider adding MANIFOLD as a valid --render argument and ViewOption, to be able to distinguish from CGAL
 
+      if (Feature::ExperimentalCsgOptimizer.is_enabled()) {
+        tree.setRoot(treeOptimizer.optimize(root_node));
+        renderStatistic.setTreeOptimizer(&treeOptimizer);
+      }
+
       constexpr bool allownef = true;
       root_geom = geomevaluator.evaluateGeometry(*tree.root(), allownef);
       if (!root_geom) root_geom = std::make_shared<PolySet>(3);
@@ -815,7 +828,7 @@ int main(int argc, char **argv)
     ("camera", po::value<std::string>(), "camera parameters when exporting png: =translate_x,y,z,rot_x,y,z,dist or =eye_x,y,z,center_x,y,z")
     ("autocenter", "adjust camera to look at object's center")
     ("viewall", "adjust camera to fit object")
-    ("backend", po::value<std::string>(), "3D rendering backend to use: 'CGAL' (old/slow) [default] or 'Manifold' (new/fast)")
+    ("backend", po::value<std::string>(), "3D rendering backend to use: 'CGAL' (old/slow) [default], 'CGAL-Corefinement' (exact, faster for closed meshes) or 'Manifold' (new/fast)")
     ("imgsize", po::value<std::string>(), "=width,height of exported png")
     ("render", po::value<std::string>()->implicit_value(""), "for full geometry evaluation when exporting png")
     ("preview", po::value<std::string>()->implicit_value(""), "[=throwntogether] -for ThrownTogether preview png")
@@ -824,7 +837,7 @@ int main(int argc, char **argv)
     ("view", po::value<CommaSeparatedVector>(), ("=view options: " + boost::algorithm::join(viewOptions.names(), " | ")).c_str())
     ("projection", po::value<std::string>(), "=(o)rtho or (p)erspective when exporting png")
     ("csglimit", po::value<unsigned int>(), "=n -stop rendering at n CSG elements when exporting png")
-    ("summary", po::value<std::vector<std::string>>(), "enable additional render summary and statistics: all | cache | time | camera | geometry | bounding-box | area")
+    ("summary", po::value<std::vector<std::string>>(), "enable additional render summary and statistics: all | cache | time | camera | geometry | bounding-box | area | csg-optimizer | memoization | garbage-collection")
     ("summary-file", po::value<std::string>(), "output summary information in JSON format to the given file, using '-' outputs to stdout")
     ("colorscheme", po::value<std::string>(), ("=colorscheme: " +
                                           str_join(ColorMap::inst()->colorSchemeNames(), " | ",
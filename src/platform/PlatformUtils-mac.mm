@@ -36,6 +36,16 @@ std::string PlatformUtils::userConfigPath()
   return std::string([[appSupportDir path] UTF8String]) + std::string("/") + PlatformUtils::OPENSCAD_FOLDER_NAME;
 }
 
+std::string PlatformUtils::userCachePath()
+{
+  NSError *error = nullptr;
+  NSURL *cachesDir = [[NSFileManager defaultManager] URLForDirectory:NSCachesDirectory inDomain:NSUserDomainMask appropriateForURL:nil create:YES error:&error];
+  if (error) {
+    return "";
+  }
+  return std::string([[cachesDir path] UTF8String]) + std::string("/") + PlatformUtils::OPENSCAD_FOLDER_NAME;
+}
+
 unsigned long PlatformUtils::stackLimit()
 {
   struct rlimit limit;        
@@ -47,6 +47,21 @@ static fs::path getXdgConfigDir()
   return fs::path{};
 }
 
+static fs::path getXdgCacheDir()
+{
+  const char *xdg_env = getenv("XDG_CACHE_HOME");
+  if (xdg_env && fs::path{xdg_env}.is_absolute()) {
+    return fs::path{xdg_env};
+  } else {
+    const char *home = getenv("HOME");
+    if (home) {
+      return fs::path{home} / ".cache";
+    }
+  }
+
+  return fs::path{};
+}
+
 // see https://www.freedesktop.org/wiki/Software/xdg-user-dirs/
 // This partially implements the xdg-user-dir handling by reading the
 // user-dirs.dirs file generated by the xdg-user-dirs-update tool. Missing
@@ -121,6 +136,15 @@ std::string PlatformUtils::userConfigPath()
   return "";
 }
 
+std::string PlatformUtils::userCachePath()
+{
+  const fs::path cache_dir = getXdgCacheDir();
+  if (cache_dir.empty()) {
+    return "";
+  }
+  return fs::absolute(cache_dir / OPENSCAD_FOLDER_NAME).generic_string();
+}
+
 unsigned long PlatformUtils::stackLimit()
 {
 #ifndef __EMSCRIPTEN__
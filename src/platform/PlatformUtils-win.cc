@@ -113,6 +113,15 @@ std::string PlatformUtils::userConfigPath()
   return retval + std::string("/") + PlatformUtils::OPENSCAD_FOLDER_NAME;
 }
 
+std::string PlatformUtils::userCachePath()
+{
+  const std::string retval = getFolderPath(CSIDL_LOCAL_APPDATA);
+  if (retval.empty()) {
+    return "";
+  }
+  return retval + std::string("/") + PlatformUtils::OPENSCAD_FOLDER_NAME + std::string("/cache");
+}
+
 unsigned long PlatformUtils::stackLimit()
 {
   return STACK_LIMIT_DEFAULT;
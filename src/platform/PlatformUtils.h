@@ -51,6 +51,17 @@ std::string userLibraryPath();
  */
 std::string userConfigPath();
 
+/**
+ * Base path where cached data can be written to. On Linux this is
+ * $XDG_CACHE_HOME, on Windows a folder inside the local AppData folder
+ * and on MacOS the user's Caches folder. The returned path already
+ * includes an OpenSCAD specific part, but may not exist yet.
+ *
+ * @return absolute path to the cache folder or an empty string if
+ * there is no suitable location.
+ */
+std::string userCachePath();
+
 bool createUserLibraryPath();
 std::string backupPath();
 bool createBackupPath();
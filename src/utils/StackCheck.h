@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdlib>
 #include "platform/PlatformUtils.h"
 
@@ -8,12 +9,36 @@ class StackCheck
 public:
   static StackCheck& inst()
   {
-    static StackCheck instance;
+    static thread_local StackCheck instance;
     return instance;
   }
 
   inline bool check() { return size() >= limit; }
 
+  // Measures the stack from where it's created, with at most the given limit.
+  // Used on threads with smaller stacks than the main thread.
+  class Scope
+  {
+public:
+    Scope(unsigned long limit) : check(inst()), ptr(check.ptr), limit(check.limit) {
+      const unsigned long used = check.size();
+      check.limit = std::min(limit, this->limit > used ? this->limit - used : 0);
+      unsigned char c;
+      check.ptr = &c; // NOLINT(*StackAddressEscape)
+    }
+    ~Scope() {
+      check.ptr = ptr;
+      check.limit = limit;
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    StackCheck& check;
+    unsigned char *ptr;
+    unsigned long limit;
+  };
+
 private:
   StackCheck() : limit(PlatformUtils::stackLimit()) {
     unsigned char c;
@@ -3,7 +3,13 @@
 #include <cstdint>
 #include <boost/functional/hash.hpp>
 
+#include <cmath>
 #include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
 
 namespace std {
 std::size_t hash<Vector3f>::operator()(const Vector3f& s) const {
@@ -37,3 +43,68 @@ size_t hash_value(Eigen::Matrix<int64_t, 3, 1> const& v) {
   return seed;
 }
 }
+
+namespace {
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+// Finalizer of MurmurHash3
+inline uint64_t fmix(uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+constexpr uint64_t k1 = 0x87c37b91114253d5ULL;
+constexpr uint64_t k2 = 0x4cf5ad432745937fULL;
+
+} // namespace
+
+void ContentHash::add(const void *data, size_t size)
+{
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  const size_t words = size / 8;
+  for (size_t i = 0; i < words; ++i) {
+    uint64_t w;
+    std::memcpy(&w, bytes + i * 8, 8);
+    h1 = rotl(h1 ^ (rotl(w * k1, 31) * k2), 27) * 5 + 0x52dce729;
+    h2 = rotl(h2 ^ (rotl(w * k2, 33) * k1), 31) * 5 + 0x38495ab5 + h1;
+  }
+  const size_t rest = size % 8;
+  if (rest) {
+    uint64_t w = 0;
+    std::memcpy(&w, bytes + words * 8, rest);
+    h1 ^= rotl(w * k1, 31) * k2;
+    h2 ^= rotl(w * k2, 33) * k1;
+  }
+  length += size;
+}
+
+void ContentHash::addCoordinates(const double *values, size_t count)
+{
+  for (size_t i = 0; i < count; ++i) {
+    double value = values[i];
+    if (value == 0.0) value = 0.0;
+    else if (std::isnan(value)) value = std::numeric_limits<double>::quiet_NaN();
+    add(&value, sizeof(value));
+  }
+}
+
+std::string ContentHash::hex() const
+{
+  uint64_t a = h1 ^ length;
+  uint64_t b = h2 ^ length;
+  a += b;
+  b += a;
+  a = fmix(a);
+  b = fmix(b);
+  a += b;
+  b += a;
+  std::ostringstream stream;
+  stream << std::hex << std::setfill('0') << std::setw(16) << a << std::setw(16) << b;
+  return stream.str();
+}
@@ -3,6 +3,7 @@
 #include "geometry/linalg.h"
 #include <cstdint>
 #include <cstddef>
+#include <string>
 
 using Vector3l = Eigen::Matrix<int64_t, 3, 1>;
 
@@ -17,3 +18,26 @@ size_t hash_value(Vector3f const& v);
 size_t hash_value(Vector3d const& v);
 size_t hash_value(Vector3l const& v);
 }
+
+/*!
+   128 bit hash of binary data, used to identify large node parameters such
+   as polyhedron points in cache keys without printing them. Not meant to
+   withstand deliberate collisions, but accidental ones are negligible at
+   128 bits even across millions of cached nodes, so keys use the hash alone.
+ */
+class ContentHash
+{
+public:
+  void add(const void *data, size_t size);
+  void add(uint64_t value) { add(&value, sizeof(value)); }
+  /*! Adds coordinates with -0.0 hashed as 0.0 and all NaNs hashed alike, so
+      coordinates comparing equal as values give the same hash. */
+  void addCoordinates(const double *values, size_t count);
+
+  [[nodiscard]] std::string hex() const;
+
+private:
+  uint64_t h1 = 0x9e3779b97f4a7c15ULL;
+  uint64_t h2 = 0xc2b2ae3d27d4eb4fULL;
+  uint64_t length = 0;
+};
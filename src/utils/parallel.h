@@ -25,6 +25,19 @@ void parallelizable_transform(const InputIterator begin1,
   std::transform(begin1, end1, out, op);
 }
 
+template <class Operation>
+void parallelizable_for(size_t begin, size_t end, const Operation &op) {
+#if ENABLE_TBB
+  if (!getenv("OPENSCAD_NO_PARALLEL")) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(begin, end), [&](auto range) {
+      for (size_t i = range.begin(); i != range.end(); i++) op(i);
+    });
+    return;
+  }
+#endif
+  for (size_t i = begin; i < end; i++) op(i);
+}
+
 template <class Container1, class Container2, class OutputIterator,
           class Operation>
 void parallelizable_cross_product_transform(const Container1 &cont1,
@@ -1,4 +1,5 @@
 #include "utils/printutils.h"
+#include <atomic>
 #include <exception>
 #include <cassert>
 #include <set>
@@ -18,6 +19,8 @@ namespace fs = std::filesystem;
 std::set<std::string> printedDeprecations;
 std::list<std::string> print_messages_stack;
 std::list<struct Message> log_messages_stack;
+static std::atomic<size_t> printed_message_count{0};
+static thread_local size_t *intercepted_message_count = nullptr;
 OutputHandlerFunc *outputhandler = nullptr;
 OutputHandlerFunc2 *outputhandler2 = nullptr;
 void *outputhandler_data = nullptr;
@@ -79,7 +82,9 @@ void print_messages_pop()
 
 void PRINT(const Message& msgObj)
 {
+  if (intercept_message()) return;
   if (msgObj.msg.empty() && msgObj.group != message_group::Echo) return;
+  ++printed_message_count;
 
   if (print_messages_stack.size() > 0) {
     if (!print_messages_stack.back().empty()) {
@@ -98,8 +103,27 @@ void PRINT(const Message& msgObj)
   }
 }
 
+size_t print_message_count()
+{
+  return printed_message_count;
+}
+
+void intercept_messages(size_t *counter)
+{
+  intercepted_message_count = counter;
+}
+
+bool intercept_message()
+{
+  if (!intercepted_message_count) return false;
+  ++*intercepted_message_count;
+  ++printed_message_count;
+  return true;
+}
+
 void PRINT_NOCACHE(const Message& msgObj)
 {
+  if (intercept_message()) return;
   if (msgObj.msg.empty() && msgObj.group != message_group::Echo) return;
 
   const auto msg = msgObj.str();
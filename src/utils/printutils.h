@@ -109,6 +109,13 @@ void resetSuppressedMessages();
 /* PRINT statements come out in same window as ECHO.
    usage: PRINTB("Var1: %s Var2: %i", var1 % var2 ); */
 void PRINT(const Message& msgObj);
+// Number of messages passed to PRINT() so far, used to detect evaluations with output
+size_t print_message_count();
+// While a counter is set, messages logged on the calling thread are only counted
+// there (and in print_message_count()) instead of being printed. Used to evaluate
+// speculatively on worker threads, see ParallelEvaluation.
+void intercept_messages(size_t *counter);
+bool intercept_message();
 
 void PRINT_NOCACHE(const Message& msgObj);
 #define PRINTB_NOCACHE(_fmt, _arg) do { } while (0)
@@ -222,6 +229,7 @@ extern std::set<std::string> printedDeprecations;
 template <typename ... Args>
 void LOG(const message_group& msgGroup, Location loc, std::string docPath, std::string&& f, Args&&... args)
 {
+  if (intercept_message()) return;
   auto formatted = MessageClass<Args...>{std::move(f), std::forward<Args>(args)...}.format();
 
   //check for deprecations
@@ -0,0 +1,122 @@
+/*
+   Tests for CSGTreeNormalizer, which rewrites CSG trees into the sum of
+   products form drawn by the OpenCSG preview.
+
+   Branches below the top-level unions are normalized independently, in
+   parallel where supported, unless they share subtrees.
+ */
+
+#include "unittest.h"
+
+#include "glview/preview/CSGTreeNormalizer.h"
+#include "core/CSGNode.h"
+#include "geometry/PolySet.h"
+#include "geometry/linalg.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using unittest::check;
+
+const std::shared_ptr<const PolySet> unitCube = [] {
+  auto ps = std::make_shared<PolySet>(3);
+  for (int i = 0; i < 8; ++i) ps->vertices.emplace_back(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+  ps->indices = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+  return ps;
+}();
+
+// Cube of the given size, placed at x
+std::shared_ptr<CSGNode> cube(double x, double size, int index)
+{
+  Transform3d m = Transform3d::Identity();
+  m.translate(Vector3d(x, 0, 0));
+  m.scale(size);
+  return std::make_shared<CSGLeaf>(unitCube, m, Color4f(), "cube" + std::to_string(index), index);
+}
+
+std::shared_ptr<CSGNode> op(OpenSCADOperator type, const std::shared_ptr<CSGNode>& left, const std::shared_ptr<CSGNode>& right)
+{
+  return CSGOperation::createCSGNode(type, left, right);
+}
+
+// Cube at x with two cubes cut out of it: x - (y + z), which normalizes to (x - y) - z
+std::shared_ptr<CSGNode> cutCube(double x, int index)
+{
+  return op(OpenSCADOperator::DIFFERENCE, cube(x, 1, index),
+            op(OpenSCADOperator::UNION, cube(x, 0.5, index + 1), cube(x + 0.5, 0.5, index + 2)));
+}
+
+// Left-deep union of the terms, as built by CSGTreeEvaluator
+std::shared_ptr<CSGNode> unionOf(const std::vector<std::shared_ptr<CSGNode>>& terms)
+{
+  std::shared_ptr<CSGNode> result = terms.front();
+  for (size_t i = 1; i < terms.size(); ++i) result = op(OpenSCADOperator::UNION, result, terms[i]);
+  return result;
+}
+
+bool hasProducts(const std::shared_ptr<CSGNode>& normalized, size_t count, size_t subtractions)
+{
+  if (!normalized) return false;
+  CSGProducts products;
+  products.import(normalized);
+  if (products.products.size() != count) return false;
+  for (const auto& product : products.products) {
+    if (product.intersections.size() != 1 || product.subtractions.size() != subtractions) return false;
+  }
+  return true;
+}
+
+void testDisjointBranches()
+{
+  std::vector<std::shared_ptr<CSGNode>> branches;
+  for (int i = 0; i < 4; ++i) branches.push_back(cutCube(2 * i, 3 * i));
+  CSGTreeNormalizer normalizer(1000);
+  const auto normalized = normalizer.normalize(unionOf(branches));
+  check(normalizer.getIndependentBranches() == 4, "disjoint branches are normalized independently");
+  check(normalizer.getTermCount() == 12, "disjoint branches keep all terms");
+  check(hasProducts(normalized, 4, 2), "disjoint branches give one product each");
+}
+
+void testSharedWithinBranch()
+{
+  // The same difference is intersected with itself, which stays within one branch
+  const auto shared = cutCube(0, 0);
+  CSGTreeNormalizer normalizer(1000);
+  const auto normalized = normalizer.normalize(unionOf({op(OpenSCADOperator::INTERSECTION, shared, shared), cutCube(4, 3), cutCube(8, 6)}));
+  check(normalizer.getIndependentBranches() == 3, "sharing within a branch keeps branches independent");
+  check(normalized != nullptr, "sharing within a branch gives a result");
+}
+
+void testSharedBetweenBranches()
+{
+  // The same difference is used on its own and as part of an intersection
+  const auto shared = cutCube(0, 0);
+  CSGTreeNormalizer normalizer(1000);
+  const auto normalized = normalizer.normalize(unionOf({shared, op(OpenSCADOperator::INTERSECTION, cube(0.25, 1, 3), shared), cutCube(4, 4)}));
+  check(normalizer.getIndependentBranches() == 0, "branches sharing a subtree are normalized one after another");
+  check(normalizer.getTermCount() == 10, "branches sharing a subtree keep all terms");
+  check(normalized != nullptr, "branches sharing a subtree give a result");
+}
+
+void testLimit()
+{
+  std::vector<std::shared_ptr<CSGNode>> branches;
+  for (int i = 0; i < 4; ++i) branches.push_back(cutCube(2 * i, 3 * i));
+  CSGTreeNormalizer normalizer(8);
+  check(normalizer.normalize(unionOf(branches)) == nullptr, "normalization aborts past the limit");
+}
+
+} // namespace
+
+int main()
+{
+  testDisjointBranches();
+  testSharedWithinBranch();
+  testSharedBetweenBranches();
+  testLimit();
+  return unittest::result();
+}
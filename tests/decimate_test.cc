@@ -0,0 +1,134 @@
+/*
+   Tests for PolySetUtils::decimate(), which simplifies meshes drawn at a
+   coarser level of detail in the interactive view.
+ */
+
+#include "unittest.h"
+
+#include "geometry/PolySetUtils.h"
+#include "geometry/PolySet.h"
+#include "geometry/linalg.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+namespace {
+
+using unittest::check;
+
+// Triangulated UV sphere
+std::unique_ptr<PolySet> sphere(double r, int segments)
+{
+  auto ps = std::make_unique<PolySet>(3);
+  const int rings = segments / 2;
+  ps->vertices.emplace_back(0, 0, r);
+  for (int i = 1; i < rings; ++i) {
+    const double phi = M_PI * i / rings;
+    for (int j = 0; j < segments; ++j) {
+      const double theta = 2 * M_PI * j / segments;
+      ps->vertices.emplace_back(r * std::sin(phi) * std::cos(theta), r * std::sin(phi) * std::sin(theta), r * std::cos(phi));
+    }
+  }
+  ps->vertices.emplace_back(0, 0, -r);
+  const int bottom = ps->vertices.size() - 1;
+  const auto ring = [&](int i, int j) { return 1 + (i - 1) * segments + (j % segments); };
+  for (int j = 0; j < segments; ++j) {
+    ps->indices.push_back({0, ring(1, j + 1), ring(1, j)});
+    ps->indices.push_back({bottom, ring(rings - 1, j), ring(rings - 1, j + 1)});
+  }
+  for (int i = 1; i < rings - 1; ++i) {
+    for (int j = 0; j < segments; ++j) {
+      ps->indices.push_back({ring(i, j), ring(i, j + 1), ring(i + 1, j + 1)});
+      ps->indices.push_back({ring(i, j), ring(i + 1, j + 1), ring(i + 1, j)});
+    }
+  }
+  ps->setTriangular(true);
+  return ps;
+}
+
+// Box with each side split into n x n quads
+std::unique_ptr<PolySet> gridBox(const Vector3d& size, int n)
+{
+  auto ps = std::make_unique<PolySet>(3);
+  for (int axis = 0; axis < 3; ++axis) {
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+    for (int side = 0; side < 2; ++side) {
+      const auto point = [&](int i, int j) {
+        Vector3d p;
+        p[axis] = side * size[axis];
+        p[u] = size[u] * i / n;
+        p[v] = size[v] * j / n;
+        ps->vertices.push_back(p);
+        return static_cast<int>(ps->vertices.size() - 1);
+      };
+      for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+          IndexedFace face = {point(i, j), point(i + 1, j), point(i + 1, j + 1), point(i, j + 1)};
+          if (side == 1) std::reverse(face.begin(), face.end());
+          ps->indices.push_back(face);
+        }
+      }
+    }
+  }
+  return ps;
+}
+
+bool validIndices(const PolySet& ps)
+{
+  for (const auto& face : ps.indices) {
+    if (face.size() != 3) return false;
+    for (const auto idx : face) {
+      if (idx < 0 || static_cast<size_t>(idx) >= ps.vertices.size()) return false;
+    }
+  }
+  return true;
+}
+
+bool sameBounds(const BoundingBox& a, const BoundingBox& b, double tolerance)
+{
+  return (a.min() - b.min()).cwiseAbs().maxCoeff() <= tolerance &&
+         (a.max() - b.max()).cwiseAbs().maxCoeff() <= tolerance;
+}
+
+void testSphere()
+{
+  const auto ps = sphere(10, 64);
+  const int resolution = 8;
+  const auto decimated = PolySetUtils::decimate(*ps, resolution);
+  check(decimated->numFacets() > 0, "sphere keeps faces");
+  check(decimated->numFacets() < ps->numFacets() / 4, "sphere face count shrinks");
+  check(decimated->isTriangular() && validIndices(*decimated), "sphere gives valid triangles");
+  check(sameBounds(decimated->getBoundingBox(), ps->getBoundingBox(), 20.0 / resolution), "sphere bounding box is preserved");
+}
+
+void testGridBox()
+{
+  const auto ps = gridBox(Vector3d(20, 10, 5), 16);
+  const int resolution = 4;
+  const auto decimated = PolySetUtils::decimate(*ps, resolution);
+  check(decimated->numFacets() > 0, "box keeps faces");
+  check(decimated->numFacets() < ps->numFacets(), "box face count shrinks");
+  check(decimated->isTriangular() && validIndices(*decimated), "box gives valid triangles");
+  // Corners are where three planes meet, so they are kept exactly
+  check(sameBounds(decimated->getBoundingBox(), ps->getBoundingBox(), 1e-9), "box bounding box is preserved");
+}
+
+void testEmpty()
+{
+  const auto ps = sphere(10, 16);
+  check(PolySetUtils::decimate(*ps, 0)->isEmpty(), "zero resolution gives an empty result");
+  check(PolySetUtils::decimate(PolySet(3), 8)->isEmpty(), "empty input gives an empty result");
+}
+
+} // namespace
+
+int main()
+{
+  testSphere();
+  testGridBox();
+  testEmpty();
+  return unittest::result();
+}
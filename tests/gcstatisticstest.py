@@ -0,0 +1,49 @@
+#!/usr/bin/env python
+
+# Garbage collection statistics checker
+#
+# Evaluates a file and writes the collection counts from the garbage-collection
+# summary, which only depend on the evaluation, to the output file. Pause times
+# vary between runs, so they are only checked for consistency.
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] outputfile
+
+import sys, subprocess, os, json, argparse
+
+def failquit(*args):
+    if len(args) != 0:
+        print(*args, file=sys.stderr)
+    sys.exit(1)
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--openscad', required=True, help='Specify OpenSCAD executable.')
+args,remaining_args = parser.parse_known_args()
+inputfile = remaining_args[0]
+outputfile = remaining_args[-1]
+basename = os.path.splitext(outputfile)[0]
+echofile = basename + '.echo'
+summaryfile = basename + '.json'
+remaining_args = remaining_args[1:-1] # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit('cant find input file named: ' + inputfile)
+if not os.path.exists(args.openscad):
+    failquit('cant find openscad executable named: ' + args.openscad)
+
+export_cmd = [args.openscad, inputfile, '-o', echofile, '--summary=garbage-collection', '--summary-file=' + summaryfile] + remaining_args
+print('Running OpenSCAD:', file=sys.stderr)
+print(' '.join(export_cmd), file=sys.stderr)
+sys.stderr.flush()
+subprocess.check_call(export_cmd)
+
+with open(summaryfile) as f:
+    statistics = json.load(f)['garbage_collection']
+os.unlink(summaryfile)
+os.unlink(echofile)
+
+if statistics['max_pause_us'] > statistics['total_pause_us']:
+    failquit('longest pause exceeds total pause: ' + str(statistics))
+
+with open(outputfile, 'w') as f:
+    for key in ['minor_collections', 'major_collections', 'contexts_freed']:
+        print('%s: %d' % (key, statistics[key]), file=f)
@@ -0,0 +1,109 @@
+/*
+   Microbenchmarks for Reindexer<Vector3d>, comparing the open addressing table
+   against the std::unordered_map based implementation it replaced.
+
+   Inputs mimic mesh building: every vertex of a triangulated grid is looked up
+   once per incident triangle corner, so most lookups hit existing entries.
+ */
+
+#include "geometry/Reindexer.h"
+#include "geometry/linalg.h"
+#include "utils/hash.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// The previous Reindexer implementation, kept as a baseline.
+template <typename T>
+class MapReindexer
+{
+public:
+  int lookup(const T& val) {
+    auto iter = this->map.find(val);
+    if (iter != this->map.end()) return iter->second;
+    this->vec.push_back(val);
+    this->map.insert(std::make_pair(val, this->vec.size() - 1));
+    return this->vec.size() - 1;
+  }
+  void reserve(std::size_t n) {
+    this->map.reserve(n);
+    this->vec.reserve(n);
+  }
+  [[nodiscard]] std::size_t size() const { return this->vec.size(); }
+
+private:
+  std::unordered_map<T, int> map;
+  std::vector<T> vec;
+};
+
+// Triangle corners of an n x n grid of quads, in face order.
+std::vector<Vector3d> grid_corners(int n)
+{
+  std::vector<Vector3d> corners;
+  corners.reserve(static_cast<std::size_t>(n) * n * 6);
+  auto v = [n](int i, int j) { return Vector3d(i * 0.1, j * 0.1, ((i * 7 + j * 13) % 11) * 0.01); };
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      corners.push_back(v(i, j));
+      corners.push_back(v(i + 1, j));
+      corners.push_back(v(i + 1, j + 1));
+      corners.push_back(v(i, j));
+      corners.push_back(v(i + 1, j + 1));
+      corners.push_back(v(i, j + 1));
+    }
+  }
+  return corners;
+}
+
+template <class R>
+void BM_Weld(benchmark::State& state)
+{
+  const auto corners = grid_corners(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    R reindexer;
+    for (const auto& c : corners) benchmark::DoNotOptimize(reindexer.lookup(c));
+    benchmark::DoNotOptimize(reindexer.size());
+  }
+  state.SetItemsProcessed(state.iterations() * corners.size());
+}
+
+template <class R>
+void BM_WeldReserved(benchmark::State& state)
+{
+  const auto corners = grid_corners(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    R reindexer;
+    reindexer.reserve(corners.size());
+    for (const auto& c : corners) benchmark::DoNotOptimize(reindexer.lookup(c));
+    benchmark::DoNotOptimize(reindexer.size());
+  }
+  state.SetItemsProcessed(state.iterations() * corners.size());
+}
+
+void BM_WeldBulk(benchmark::State& state)
+{
+  const auto corners = grid_corners(static_cast<int>(state.range(0)));
+  std::vector<int> indices(corners.size());
+  for (auto _ : state) {
+    Reindexer<Vector3d> reindexer;
+    reindexer.lookup(corners.begin(), corners.end(), indices.begin());
+    benchmark::DoNotOptimize(indices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * corners.size());
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Weld, MapReindexer<Vector3d>)->Range(16, 256);
+BENCHMARK_TEMPLATE(BM_Weld, Reindexer<Vector3d>)->Range(16, 256);
+BENCHMARK_TEMPLATE(BM_WeldReserved, MapReindexer<Vector3d>)->Range(16, 256);
+BENCHMARK_TEMPLATE(BM_WeldReserved, Reindexer<Vector3d>)->Range(16, 256);
+BENCHMARK(BM_WeldBulk)->Range(16, 256);
+
+BENCHMARK_MAIN();
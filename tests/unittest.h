@@ -0,0 +1,33 @@
+#pragma once
+
+/*
+   Minimal checks shared by the unit tests in this directory. A test calls
+   check() for each expectation and returns unittest::result() from main(),
+   so ctest sees a failure if any check failed.
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+namespace unittest {
+
+inline int failures = 0;
+
+inline void check(bool condition, const char *what)
+{
+  if (!condition) {
+    std::cerr << "FAILED: " << what << std::endl;
+    failures++;
+  }
+}
+
+inline int result()
+{
+  if (failures) {
+    std::cerr << failures << " checks failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+} // namespace unittest
@@ -0,0 +1,92 @@
+/*
+   Tests for VBOInstancePlan, which decides which preview surfaces share one
+   copy of their vertex data. It makes no OpenGL calls, so no context is needed.
+ */
+
+#include "unittest.h"
+
+#include "glview/VBOInstancePlan.h"
+#include "geometry/PolySet.h"
+#include "geometry/linalg.h"
+
+namespace {
+
+using unittest::check;
+
+Transform3d translation(double x, double y, double z)
+{
+  Transform3d m = Transform3d::Identity();
+  m.translate(Vector3d(x, y, z));
+  return m;
+}
+
+Transform3d mirror()
+{
+  Transform3d m = Transform3d::Identity();
+  m.scale(Vector3d(-1, 1, 1));
+  return m;
+}
+
+// Plans only look at the identity and colors of a PolySet, not its faces
+PolySet cube(3);
+PolySet sphere(3);
+
+void testSingleUse()
+{
+  VBOInstancePlan plan;
+  plan.add(cube, Transform3d::Identity(), 36);
+  check(!plan.isInstanced(cube, Transform3d::Identity()), "single use is not instanced");
+  check(plan.numVertices() == 36, "single use allocates its vertices");
+  check(plan.numVerticesUnshared() == 36, "single use unshared vertices");
+  check(plan.numInstances() == 0, "single use has no instances");
+}
+
+void testRepeatedUses()
+{
+  VBOInstancePlan plan;
+  for (int i = 0; i < 4; ++i) plan.add(cube, translation(i, 0, 0), 36);
+  plan.add(sphere, Transform3d::Identity(), 100);
+  check(plan.isInstanced(cube, translation(2, 0, 0)), "repeated use is instanced");
+  check(!plan.isInstanced(sphere, Transform3d::Identity()), "other single use is not instanced");
+  check(plan.numVertices() == 36 + 100, "repeated uses are allocated once");
+  check(plan.numVerticesUnshared() == 4 * 36 + 100, "unshared counts every use");
+  check(plan.numInstances() == 4, "every repeated use is an instance");
+}
+
+void testMirrored()
+{
+  VBOInstancePlan plan;
+  plan.add(cube, Transform3d::Identity(), 36);
+  plan.add(cube, translation(1, 0, 0), 36);
+  plan.add(cube, mirror(), 36);
+  check(!VBOInstancePlan::canInstance(mirror()), "mirroring can't be instanced");
+  check(plan.isInstanced(cube, Transform3d::Identity()), "unmirrored use is instanced");
+  check(!plan.isInstanced(cube, mirror()), "mirrored use is not instanced");
+  check(plan.numVertices() == 2 * 36, "mirrored use is allocated separately");
+  check(plan.numInstances() == 2, "mirrored use is no instance");
+}
+
+void testNotShareable()
+{
+  PolySet colored(3);
+  colored.colors.emplace_back(1.0f, 0.0f, 0.0f);
+  colored.color_indices.push_back(0);
+  VBOInstancePlan plan;
+  plan.add(colored, Transform3d::Identity(), 36);
+  plan.add(colored, translation(1, 0, 0), 36);
+  check(!VBOInstancePlan::canInstance(colored), "per-face colors can't be instanced");
+  check(!plan.isInstanced(colored, Transform3d::Identity()), "per-face colored surface is not instanced");
+  check(plan.numVertices() == 2 * 36, "per-face colored uses are allocated separately");
+  check(plan.numInstances() == 0, "per-face colored uses are no instances");
+}
+
+} // namespace
+
+int main()
+{
+  testSingleUse();
+  testRepeatedUses();
+  testMirrored();
+  testNotShareable();
+  return unittest::result();
+}
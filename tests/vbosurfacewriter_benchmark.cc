@@ -0,0 +1,80 @@
+/*
+   Microbenchmarks for VBOUtils::writeSurfaceVertices(), comparing the parallel
+   writer against the same writer restricted to one thread with
+   OPENSCAD_NO_PARALLEL. Without TBB both run sequentially.
+
+   Surfaces are written to a plain buffer with the interleaved layout of the
+   preview renderers, so no OpenGL context is needed.
+ */
+
+#include "glview/VBOSurfaceWriter.h"
+#include "geometry/PolySet.h"
+#include "geometry/linalg.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Height field of n x n quads, with an extra triangle fan polygon per row
+std::unique_ptr<PolySet> grid(int n)
+{
+  auto ps = std::make_unique<PolySet>(3);
+  const auto v = [n](int i, int j) { return i * (n + 1) + j; };
+  for (int i = 0; i <= n; ++i) {
+    for (int j = 0; j <= n; ++j) {
+      ps->vertices.emplace_back(i * 0.1, j * 0.1, ((i * 7 + j * 13) % 11) * 0.01);
+    }
+  }
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      ps->indices.push_back({v(i, j), v(i + 1, j), v(i + 1, j + 1), v(i, j + 1)});
+    }
+    ps->indices.push_back({v(i, 0), v(i, 1), v(i, 2), v(i + 1, 2), v(i + 1, 1)});
+  }
+  return ps;
+}
+
+// Position, normal and color floats followed by barycentric bytes, as set up by
+// VBOBuilder::addSurfaceData() and VBOBuilder::addShaderData()
+const VBOSurfaceLayout layout{3 * sizeof(float) + 3 * sizeof(float) + 4 * sizeof(float) + 4, 0, 12, 24, 40};
+
+void writeSurface(benchmark::State& state)
+{
+  const auto ps = grid(static_cast<int>(state.range(0)));
+  Transform3d m = Transform3d::Identity();
+  m.translate(Vector3d(1, 2, 3));
+  const size_t num_vertices = VBOUtils::numSurfaceVertices(*ps);
+  std::vector<uint8_t> buffer(num_vertices * layout.stride);
+  for (auto _ : state) {
+    VBOUtils::writeSurfaceVertices(*ps, m, Color4f(1.0f, 1.0f, 0.0f), false, layout, buffer.data());
+    benchmark::DoNotOptimize(buffer.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * num_vertices);
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+void BM_WriteSurfaceSequential(benchmark::State& state)
+{
+  setenv("OPENSCAD_NO_PARALLEL", "1", 1);
+  writeSurface(state);
+  unsetenv("OPENSCAD_NO_PARALLEL");
+}
+
+void BM_WriteSurfaceParallel(benchmark::State& state)
+{
+  writeSurface(state);
+}
+
+} // namespace
+
+BENCHMARK(BM_WriteSurfaceSequential)->Range(32, 512)->UseRealTime();
+BENCHMARK(BM_WriteSurfaceParallel)->Range(32, 512)->UseRealTime();
+
+BENCHMARK_MAIN();